@@ -0,0 +1,327 @@
+#include "ai.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Heuristic for one packed row: rewards empty cells, mergeable neighbours and
+// monotonic rows, penalises large tiles spread around the board
+static float scoreRowHeuristic(uint32_t row) {
+    int cells[GRID_SIZE];
+    for (int c = 0; c < GRID_SIZE; ++c) {
+        cells[c] = (row >> (c * CELL_BITS)) & CELL_MASK;
+    }
+
+    float sum = 0;
+    int empty = 0;
+    int merges = 0;
+    int previous = 0;
+    int run = 0;
+    for (int c = 0; c < GRID_SIZE; ++c) {
+        int rank = cells[c];
+        sum += std::pow((float)rank, 3.5f);
+        if (rank == 0) {
+            ++empty;
+            continue;
+        }
+        if (previous == rank) {
+            ++run;
+        }
+        else if (run > 0) {
+            merges += 1 + run;
+            run = 0;
+        }
+        previous = rank;
+    }
+    if (run > 0) merges += 1 + run;
+
+    float monotonicLeft = 0;
+    float monotonicRight = 0;
+    for (int c = 1; c < GRID_SIZE; ++c) {
+        float left = std::pow((float)cells[c - 1], 4.0f);
+        float right = std::pow((float)cells[c], 4.0f);
+        if (cells[c - 1] > cells[c]) monotonicLeft += left - right;
+        else monotonicRight += right - left;
+    }
+
+    return 200000.0f + 270.0f * empty + 700.0f * merges - 47.0f * std::min(monotonicLeft, monotonicRight) - 11.0f * sum;
+}
+
+// Row heuristics for every row that fits the 4-bit table, built on first use
+struct RowHeuristicTable {
+    std::vector<float> entries;
+
+    RowHeuristicTable() : entries(ROW_TABLE_SIZE) {
+        for (uint32_t key = 0; key < ROW_TABLE_SIZE; ++key) {
+            entries[key] = scoreRowHeuristic(tableKeyToRow(key));
+        }
+    }
+};
+
+static float rowHeuristic(uint32_t row) {
+    static const RowHeuristicTable table;
+    if (rowFitsTable(row)) return table.entries[rowToTableKey(row)];
+    return scoreRowHeuristic(row);
+}
+
+double evaluateBoard(const Board& board) {
+    Board columns = transposeBoard(board);
+    double total = 0;
+    for (int r = 0; r < GRID_SIZE; ++r) {
+        total += rowHeuristic(getRow(board, r)) + rowHeuristic(getRow(columns, r));
+    }
+    return total;
+}
+
+// Zobrist keys, one per (cell, exponent); exponent 0 hashes to nothing
+struct ZobristKeys {
+    uint64_t keys[CELL_COUNT][1 << CELL_BITS];
+
+    ZobristKeys() {
+        Rng rng(0x2048);
+        for (int cell = 0; cell < CELL_COUNT; ++cell) {
+            keys[cell][0] = 0;
+            for (int exponent = 1; exponent < (1 << CELL_BITS); ++exponent) {
+                keys[cell][exponent] = rng.next();
+            }
+        }
+    }
+};
+
+static const ZobristKeys zobrist;
+
+uint64_t hashBoard(const Board& board) {
+    uint64_t hash = 0;
+    for (int r = 0; r < GRID_SIZE; ++r) {
+        uint32_t row = getRow(board, r);
+        for (int c = 0; c < GRID_SIZE; ++c) {
+            hash ^= zobrist.keys[r * GRID_SIZE + c][(row >> (c * CELL_BITS)) & CELL_MASK];
+        }
+    }
+    return hash;
+}
+
+void TranspositionTable::resize(int newBits) {
+    if (newBits == bits) return;
+    bits = newBits;
+    mask = ((size_t)1 << bits) - 1;
+    slots.reset(new Slot[mask + 1]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= mask && slots; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, int depth, float& value) const {
+    const Slot& slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || (int)(data >> 32) < depth) return false;
+    uint32_t valueBits = (uint32_t)data;
+    std::memcpy(&value, &valueBits, sizeof(value));
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, float value) {
+    uint32_t valueBits;
+    std::memcpy(&valueBits, &value, sizeof(value));
+    uint64_t data = ((uint64_t)depth << 32) | valueBits;
+    Slot& slot = slots[key & mask];
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+static bool outOfTime(SearchEngine& engine) {
+    if (engine.aborted) return true;
+    if ((engine.stop && engine.stop->load(std::memory_order_relaxed)) ||
+        (engine.cancel && engine.cancel->load(std::memory_order_relaxed))) {
+        engine.aborted = true;
+        return true;
+    }
+    // Reading the clock is slow, so only look every 1024 nodes
+    if (engine.options.timeBudgetMs > 0 && (engine.stats.nodes & 1023) == 0 &&
+        std::chrono::steady_clock::now() >= engine.deadline) {
+        engine.aborted = true;
+        if (engine.stop) engine.stop->store(true, std::memory_order_relaxed);
+    }
+    return engine.aborted;
+}
+static double chanceNode(SearchEngine& engine, const Board& board, int depth, double probability);
+
+static double moveNode(SearchEngine& engine, const Board& board, int depth, double probability) {
+    ++engine.stats.nodes;
+    if (outOfTime(engine)) return 0;
+
+    // Evaluations go negative on boards with big tiles, so no value can double as "no move"
+    double best = -std::numeric_limits<double>::infinity();
+    bool legal = false;
+    for (int direction = 0; direction < 4; ++direction) {
+        Board next = board;
+        int score = 0;
+        if (!moveBoard(next, direction, score)) continue;
+        best = std::max(best, chanceNode(engine, next, depth, probability));
+        legal = true;
+    }
+    return legal ? best : 0; // No legal move: the game is over and worth nothing
+}
+
+static double chanceNode(SearchEngine& engine, const Board& board, int depth, double probability) {
+    ++engine.stats.nodes;
+    if (depth <= 0 || probability < engine.options.probabilityCutoff) return evaluateBoard(board);
+
+    uint64_t key = hashBoard(board);
+    float cached;
+    if (engine.table->probe(key, depth, cached)) {
+        ++engine.stats.tableHits;
+        return cached;
+    }
+
+    // Children below this node run at depth - 1 and use their own buffer
+    ChanceOutcome* outcomes = engine.outcomeBuffers[depth].data();
+    int count = generateChanceOutcomes(board, outcomes, engine.options.chanceBudget, key);
+    double total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += outcomes[i].probability * moveNode(engine, outcomes[i].board, depth - 1, probability * outcomes[i].probability);
+    }
+    if (engine.aborted) return 0;
+
+    engine.table->store(key, depth, (float)total);
+    return total;
+}
+
+static void prepareEngine(SearchEngine& engine, const SearchOptions& options, std::chrono::steady_clock::time_point start) {
+    if ((int)engine.outcomeBuffers.size() <= options.maxDepth) {
+        engine.outcomeBuffers.resize(options.maxDepth + 1, std::vector<ChanceOutcome>(MAX_CHANCE_OUTCOMES));
+    }
+    engine.options = options;
+    engine.stats = SearchStats();
+    engine.deadline = start + std::chrono::milliseconds(options.timeBudgetMs);
+    engine.aborted = false;
+}
+
+static int firstLegalMove(const Board& board) {
+    for (int direction = 0; direction < 4; ++direction) {
+        Board next = board;
+        int score = 0;
+        if (moveBoard(next, direction, score)) return direction;
+    }
+    return -1;
+}
+
+SearchResult searchBestMove(SearchEngine& engine, const Board& board, const SearchOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    if (!engine.table || engine.table == &engine.ownTable) {
+        engine.ownTable.resize(options.tableBits);
+        engine.table = &engine.ownTable;
+    }
+    prepareEngine(engine, options, start);
+
+    // Iterative deepening: an iteration cut short by the time budget is thrown away
+    SearchResult result;
+    for (int depth = 1; depth <= options.maxDepth; ++depth) {
+        int bestMove = -1;
+        double bestValue = -std::numeric_limits<double>::infinity(); // Values can be negative
+        for (int direction = 0; direction < 4 && !engine.aborted; ++direction) {
+            Board next = board;
+            int score = 0;
+            if (!moveBoard(next, direction, score)) continue;
+            double value = chanceNode(engine, next, depth, 1.0);
+            if (!engine.aborted && value > bestValue) {
+                bestMove = direction;
+                bestValue = value;
+            }
+        }
+        if (engine.aborted) break;
+        result.move = bestMove;
+        result.value = bestMove >= 0 ? bestValue : 0;
+        engine.stats.depthReached = depth;
+        if (bestMove < 0) break;
+    }
+
+    // Out of time before the first iteration finished: still play a legal move
+    if (result.move < 0) result.move = firstLegalMove(board);
+
+    result.stats = engine.stats;
+    result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+ParallelSearch::ParallelSearch(int threads) : pool(threads), engines(pool.size()), stop(false), cancel(false), rootOutcomes(MAX_CHANCE_OUTCOMES) {
+    rootTasks.reserve(4 * MAX_CHANCE_OUTCOMES);
+}
+
+// What the root tasks of one depth need; the task lambda captures only a
+// reference to it, which fits std::function's inline storage, so handing it to
+// the pool does not allocate
+struct RootJob {
+    ParallelSearch* search;
+    int depth;
+};
+
+SearchResult searchBestMoveParallel(ParallelSearch& search, const Board& board, const SearchOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    search.table.resize(options.tableBits);
+    search.stop = false;
+    for (SearchEngine& engine : search.engines) {
+        engine.table = &search.table;
+        engine.stop = &search.stop;
+        engine.cancel = &search.cancel;
+        prepareEngine(engine, options, start);
+    }
+
+    std::vector<ChanceOutcome>& outcomes = search.rootOutcomes;
+    std::vector<RootTask>& tasks = search.rootTasks;
+    SearchResult result;
+    int depthReached = 0;
+    for (int depth = 1; depth <= options.maxDepth; ++depth) {
+        // Split at the root: one task per (move, spawn outcome) pair
+        tasks.clear();
+        for (int direction = 0; direction < 4; ++direction) {
+            Board next = board;
+            int score = 0;
+            if (!moveBoard(next, direction, score)) continue;
+            int count = generateChanceOutcomes(next, outcomes.data(), options.chanceBudget, hashBoard(next));
+            for (int i = 0; i < count; ++i) {
+                tasks.push_back({ direction, outcomes[i].board, outcomes[i].probability, 0 });
+            }
+        }
+        if (tasks.empty()) break;
+
+        RootJob job = { &search, depth };
+        search.pool.parallelFor((int)tasks.size(), [&job](int worker, int index) {
+            RootTask& task = job.search->rootTasks[index];
+            task.value = moveNode(job.search->engines[worker], task.board, job.depth - 1, task.probability);
+        });
+        if (search.stop || search.cancel) break;
+
+        // Sum in task order, so equal task values always give the same sums. The
+        // values themselves can still differ between runs: whether a shared table
+        // entry is a hit depends on which worker stored it first.
+        double moveValues[4] = { 0, 0, 0, 0 };
+        bool legal[4] = { false, false, false, false };
+        for (const RootTask& task : tasks) {
+            moveValues[task.move] += task.probability * task.value;
+            legal[task.move] = true;
+        }
+        int bestMove = -1;
+        for (int direction = 0; direction < 4; ++direction) {
+            if (legal[direction] && (bestMove < 0 || moveValues[direction] > moveValues[bestMove])) bestMove = direction;
+        }
+        result.move = bestMove;
+        result.value = moveValues[bestMove];
+        depthReached = depth;
+    }
+    if (result.move < 0) result.move = firstLegalMove(board);
+
+    for (const SearchEngine& engine : search.engines) {
+        result.stats.nodes += engine.stats.nodes;
+        result.stats.tableHits += engine.stats.tableHits;
+    }
+    result.stats.depthReached = depthReached;
+    result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "chance.h"
+#include "threadpool.h"
+
+// Expectimax search over the game rules. Move nodes try the 4 directions, chance
+// nodes average over the two tiles spawned after every move: a forced 2 and an
+// extra tile from {2, 4, 8, 16, 32}.
+
+struct SearchOptions {
+    int maxDepth = 3;                 // Moves to look ahead; iterative deepening stops here
+    double probabilityCutoff = 1e-4;  // Chance branches less likely than this are evaluated, not expanded
+    int timeBudgetMs = 0;             // Per-move time budget, 0 for none; results then depend only on the board
+    int tableBits = 20;               // Transposition table holds 2^tableBits entries
+    int chanceBudget = 60;            // Chance nodes with more outcomes than this are sampled, 0 for exact
+};
+
+struct SearchStats {
+    uint64_t nodes = 0;     // Move and chance nodes visited
+    uint64_t tableHits = 0; // Chance nodes answered by the transposition table
+    int depthReached = 0;   // Deepest fully completed iteration
+    double seconds = 0;
+};
+
+struct SearchResult {
+    int move = -1; // -1 when no direction changes the board
+    double value = 0;
+    SearchStats stats;
+};
+
+// Chance-node values keyed by Zobrist hash, safe to share between threads without
+// locks. Each slot stores key ^ data next to data, so two racing writes show up as
+// a key mismatch (a miss) rather than a wrong value.
+class TranspositionTable {
+public:
+    void resize(int bits);
+    void clear();
+    size_t size() const { return mask + 1; }
+    bool probe(uint64_t key, int depth, float& value) const;
+    void store(uint64_t key, int depth, float value);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data; // Value bits in the low half, depth above
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    int bits = -1;
+};
+
+// Per-searcher state; reuse one engine across moves so the table is allocated once
+struct SearchEngine {
+    TranspositionTable ownTable;
+    TranspositionTable* table = nullptr; // ownTable unless a parallel search shares one
+    std::vector<std::vector<ChanceOutcome>> outcomeBuffers; // One per depth, reused between searches
+    SearchOptions options;
+    SearchStats stats;
+    std::chrono::steady_clock::time_point deadline;
+    bool aborted = false;
+    std::atomic<bool>* stop = nullptr; // Shared cancel flag, raised by whoever runs out of time first
+    const std::atomic<bool>* cancel = nullptr; // Raised by the caller to abandon the search
+};
+
+// One root move followed by one spawn outcome, searched as a single task
+struct RootTask {
+    int move;
+    Board board;
+    double probability;
+    double value;
+};
+
+// Search spread over a thread pool. Every root move and every spawn outcome below
+// it becomes one task; all workers share one transposition table.
+struct ParallelSearch {
+    explicit ParallelSearch(int threads);
+
+    ThreadPool pool;
+    TranspositionTable table;
+    std::vector<SearchEngine> engines; // One per pool worker
+    std::atomic<bool> stop; // Deadline reached; reset by every search
+    // Set by the owner to abandon the running search. The search only reads it,
+    // so a cancel can never be lost to a search that is just starting; the owner
+    // clears it before asking for the next search.
+    std::atomic<bool> cancel;
+    // Sized for the largest root once, so searches after the first never allocate
+    std::vector<ChanceOutcome> rootOutcomes;
+    std::vector<RootTask> rootTasks;
+};
+
+uint64_t hashBoard(const Board& board);
+double evaluateBoard(const Board& board);
+SearchResult searchBestMove(SearchEngine& engine, const Board& board, const SearchOptions& options);
+SearchResult searchBestMoveParallel(ParallelSearch& search, const Board& board, const SearchOptions& options);
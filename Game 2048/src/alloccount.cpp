@@ -0,0 +1,87 @@
+#include "alloccount.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifndef NDEBUG
+
+static std::atomic<uint64_t> totalAllocations(0);
+static thread_local uint64_t threadAllocations = 0;
+
+static void* countedAllocate(std::size_t size) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    ++threadAllocations;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size) {
+    void* pointer = countedAllocate(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    void* pointer = countedAllocate(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+uint64_t allocationCount() {
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t threadAllocationCount() {
+    return threadAllocations;
+}
+
+bool allocationCountingEnabled() {
+    return true;
+}
+
+#else
+
+uint64_t allocationCount() {
+    return 0;
+}
+
+uint64_t threadAllocationCount() {
+    return 0;
+}
+
+bool allocationCountingEnabled() {
+    return false;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocations made through global operator new, for checking that hot paths
+// do not allocate. Counting is compiled into debug builds only: with NDEBUG both
+// functions return 0 and operator new is left alone. Over-aligned allocations
+// are not counted.
+uint64_t allocationCount();       // All threads
+uint64_t threadAllocationCount(); // The calling thread only, unaffected by worker threads
+
+// True when the counts above are real, false in NDEBUG builds
+bool allocationCountingEnabled();
@@ -0,0 +1,48 @@
+#include "animation.h"
+
+bool InputQueue::push(int direction) {
+    if (count == INPUT_QUEUE_SIZE) return false;
+    directions[(head + count) % INPUT_QUEUE_SIZE] = direction;
+    ++count;
+    return true;
+}
+
+bool InputQueue::pop(int& direction) {
+    if (count == 0) return false;
+    direction = directions[head];
+    head = (head + 1) % INPUT_QUEUE_SIZE;
+    --count;
+    return true;
+}
+
+void SlideAnimation::start(const TileMove* moves, int moveCount) {
+    count = moveCount;
+    for (int i = 0; i < count; ++i) {
+        tileMoves[i] = moves[i];
+    }
+    step = 0;
+    accumulator = 0;
+}
+
+void SlideAnimation::advance(double seconds) {
+    if (!active()) return;
+    accumulator += seconds;
+    while (accumulator >= ANIMATION_STEP_SECONDS && step < SLIDE_STEPS) {
+        accumulator -= ANIMATION_STEP_SECONDS;
+        ++step;
+    }
+    if (!active()) accumulator = 0;
+}
+
+// Ease-out: fast start, gentle stop
+static float slidePosition(int step) {
+    float t = (float)step / SLIDE_STEPS;
+    return 1.0f - (1.0f - t) * (1.0f - t);
+}
+
+float SlideAnimation::progress() const {
+    if (!active()) return 1.0f;
+    float alpha = (float)(accumulator / ANIMATION_STEP_SECONDS);
+    float from = slidePosition(step);
+    return from + (slidePosition(step + 1) - from) * alpha;
+}
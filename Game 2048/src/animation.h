@@ -0,0 +1,46 @@
+#pragma once
+#include "board.h"
+
+const double ANIMATION_STEP_SECONDS = 1.0 / 120; // Fixed simulation step, independent of the frame rate
+const int SLIDE_STEPS = 12;                      // 100 ms per slide
+const int INPUT_QUEUE_SIZE = 16;
+
+// Moves pressed while a slide is still playing, oldest first. Fixed capacity, no allocation.
+class InputQueue {
+public:
+    bool push(int direction); // false when full; the key press is then ignored
+    bool pop(int& direction);
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+
+private:
+    int directions[INPUT_QUEUE_SIZE];
+    int head = 0;
+    int count = 0;
+};
+
+// Slide of every tile for one move. Positions advance on a fixed timestep and
+// the renderer interpolates between the last two steps, so the motion looks the
+// same at any frame rate. The tile list is copied into a fixed array owned by
+// the animation; starting a new slide reuses it.
+class SlideAnimation {
+public:
+    void start(const TileMove* moves, int count);
+    void finish() { step = SLIDE_STEPS; }
+    bool active() const { return step < SLIDE_STEPS; }
+
+    // Runs as many fixed steps as fit in the time since the last call
+    void advance(double seconds);
+
+    // How far along the slide the tiles are drawn this frame, 0 to 1
+    float progress() const;
+
+    const TileMove* moves() const { return tileMoves; }
+    int moveCount() const { return count; }
+
+private:
+    TileMove tileMoves[CELL_COUNT];
+    int count = 0;
+    int step = SLIDE_STEPS;
+    double accumulator = 0;
+};
@@ -0,0 +1,72 @@
+#include "assetloader.h"
+#include <SDL_image.h>
+#include <chrono>
+#include <iostream>
+
+SDL_RWops* openPackedAsset(const AssetPack& pack, const char* name) {
+    const void* data;
+    size_t size;
+    if (!pack.find(name, data, size)) {
+        SDL_SetError("%s is not in the asset pack", name);
+        return nullptr;
+    }
+    return SDL_RWFromConstMem(data, (int)size);
+}
+
+SDL_Surface* decodePackedImage(const AssetPack& pack, const char* name) {
+    SDL_RWops* stream = openPackedAsset(pack, name);
+    return stream ? IMG_Load_RW(stream, 1) : nullptr;
+}
+
+ImageLoader::ImageLoader(const AssetPack& pack, const std::vector<std::string>& names, int threads, ImageCache* cache)
+    : pack(pack), names(names), surfaces(names.size(), nullptr), errors(names.size()), decoded(new std::atomic<bool>[names.size()]), cache(cache), pool(threads), hits(0), finished(false) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        decoded[i] = false;
+    }
+    thread = std::thread(&ImageLoader::run, this);
+}
+
+ImageLoader::~ImageLoader() {
+    thread.join();
+    for (SDL_Surface* surface : surfaces) {
+        SDL_FreeSurface(surface);
+    }
+}
+
+void ImageLoader::run() {
+    auto start = std::chrono::steady_clock::now();
+    // Reading the cache waits on the disk, so it happens here and not before the first frame
+    if (cache) cache->load();
+    // Each task writes only its own slot; SDL keeps error strings per thread
+    pool.parallelFor((int)names.size(), [this](int, int index) {
+        const char* name = names[index].c_str();
+        const void* data;
+        size_t size;
+        uint64_t hash = 0;
+        if (cache && pack.find(name, data, size)) {
+            hash = hashBytes(data, size);
+            surfaces[index] = cache->find(hash);
+            if (surfaces[index]) {
+                hits.fetch_add(1, std::memory_order_relaxed);
+                decoded[index].store(true, std::memory_order_release);
+                return;
+            }
+        }
+        surfaces[index] = decodePackedImage(pack, name);
+        if (!surfaces[index]) errors[index] = IMG_GetError();
+        else if (hash != 0) cache->add(hash, surfaces[index]);
+        decoded[index].store(true, std::memory_order_release);
+    });
+    if (cache) cache->save();
+    loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    finished.store(true, std::memory_order_release);
+}
+
+SDL_Surface* ImageLoader::take(int index) {
+    SDL_Surface* surface = surfaces[index];
+    surfaces[index] = nullptr;
+    if (!surface) {
+        std::cerr << "Failed to load " << names[index] << ": " << errors[index] << std::endl;
+    }
+    return surface;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <SDL.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "assetpack.h"
+#include "imagecache.h"
+#include "threadpool.h"
+
+// Read-only stream over a packed asset, nullptr if the archive has no such file.
+// The data stays in the mapping, so the pack must outlive the stream.
+SDL_RWops* openPackedAsset(const AssetPack& pack, const char* name);
+
+// Decodes one packed image; nullptr and an SDL error on failure
+SDL_Surface* decodePackedImage(const AssetPack& pack, const char* name);
+
+// Decodes packed images on a thread pool while the render thread keeps drawing.
+// Images are started in the order of names, so the first one is ready first.
+// Only surfaces are made here: turning them into textures needs the renderer and
+// stays on the render thread. With a cache, the loader reads its file first, then
+// copies images decoded on an earlier run out of it instead, and saves it before
+// done() turns true.
+class ImageLoader {
+public:
+    ImageLoader(const AssetPack& pack, const std::vector<std::string>& names, int threads, ImageCache* cache = nullptr);
+    ~ImageLoader();
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    // True once every image is decoded
+    bool done() const { return finished.load(std::memory_order_acquire); }
+    // True once names[index] is decoded, possibly well before done()
+    bool ready(int index) const { return decoded[index].load(std::memory_order_acquire); }
+
+    // Hands over names[index] once ready(index), nullptr if it failed to decode.
+    // The caller frees it.
+    SDL_Surface* take(int index);
+
+    // Valid after done()
+    double seconds() const { return loadSeconds; }
+    int cacheHits() const { return hits.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    const AssetPack& pack;
+    std::vector<std::string> names;
+    std::vector<SDL_Surface*> surfaces;
+    std::vector<std::string> errors;
+    std::unique_ptr<std::atomic<bool>[]> decoded;
+    ImageCache* cache;
+    ThreadPool pool;
+    std::atomic<int> hits;
+    double loadSeconds = 0;
+    std::atomic<bool> finished;
+    std::thread thread;
+};
@@ -0,0 +1,104 @@
+#include "assetpack.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const char* path) {
+    close();
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mappingHandle) CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+    file = fileHandle;
+    mapping = mappingHandle;
+    base = (const unsigned char*)view;
+    length = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file contents reachable
+    if (view == MAP_FAILED) return false;
+    base = (const unsigned char*)view;
+    length = (size_t)info.st_size;
+#endif
+
+    // Reject anything whose index or data would reach past the end of the file
+    const PackHeader* header = (const PackHeader*)base;
+    bool valid = length >= sizeof(PackHeader) && std::memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+        header->count <= (length - sizeof(PackHeader)) / sizeof(PackEntry);
+    if (valid) {
+        entries = (const PackEntry*)(base + sizeof(PackHeader));
+        count = header->count;
+        for (uint32_t i = 0; i < count && valid; ++i) {
+            valid = entries[i].offset <= length && entries[i].size <= length - entries[i].offset &&
+                entries[i].name[PACK_NAME_BYTES - 1] == '\0';
+        }
+    }
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle((HANDLE)mapping);
+    CloseHandle((HANDLE)file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    munmap((void*)base, length);
+#endif
+    base = nullptr;
+    length = 0;
+    entries = nullptr;
+    count = 0;
+}
+
+bool AssetPack::find(const char* name, const void*& data, size_t& size) const {
+    // Binary search; packassets writes the index sorted by name
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high) {
+        uint32_t middle = (low + high) / 2;
+        int order = std::strncmp(entries[middle].name, name, PACK_NAME_BYTES);
+        if (order == 0) {
+            data = base + entries[middle].offset;
+            size = (size_t)entries[middle].size;
+            return true;
+        }
+        if (order < 0) low = middle + 1;
+        else high = middle;
+    }
+    return false;
+}
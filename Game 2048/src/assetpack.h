@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Asset archive written by packassets and read at startup. Layout, little-endian:
+//   PackHeader
+//   PackEntry[count], sorted by name
+//   file data, each file starting on a PACK_ALIGN boundary
+// The game maps the whole file and hands each asset to SDL straight from the
+// mapping, so loading needs one open and no copies.
+const char PACK_MAGIC[8] = { '2', '0', '4', '8', 'P', 'A', 'K', '1' };
+const int PACK_NAME_BYTES = 48;
+const uint64_t PACK_ALIGN = 16;
+
+struct PackHeader {
+    char magic[8];
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct PackEntry {
+    char name[PACK_NAME_BYTES]; // File name without directories, zero-padded
+    uint64_t offset;            // From the start of the archive
+    uint64_t size;
+};
+
+static_assert(sizeof(PackHeader) == 16 && sizeof(PackEntry) == 64, "archive layout must not depend on the compiler");
+
+// Read-only memory mapping of an archive
+class AssetPack {
+public:
+    AssetPack() = default;
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Maps path and checks the index; false if it is missing or damaged
+    bool open(const char* path);
+    void close();
+
+    // Bytes of the named asset inside the mapping, valid until close()
+    bool find(const char* name, const void*& data, size_t& size) const;
+
+private:
+    const unsigned char* base = nullptr;
+    size_t length = 0;
+    const PackEntry* entries = nullptr;
+    uint32_t count = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
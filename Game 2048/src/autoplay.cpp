@@ -0,0 +1,45 @@
+#include "autoplay.h"
+
+void Autoplay::start(const Board& board, int score, uint64_t seed) {
+    stop();
+    stopping = false;
+    thread = std::thread(&Autoplay::run, this, board, score, seed);
+}
+
+void Autoplay::stop() {
+    if (!thread.joinable()) return;
+    stopping = true;
+    thread.join();
+}
+
+void Autoplay::run(Board board, int score, uint64_t seed) {
+    Rng rng(seed);
+    uint64_t moves = 0;
+    uint64_t games = 0;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        int direction = isBoardGameOver(board) ? -1 : policy(board, rng);
+        if (direction < 0) {
+            ++games;
+            score = 0;
+            initializeBoard(board, rng);
+        }
+        else {
+            moveBoard(board, direction, score);
+            spawnTiles(board, rng);
+            ++moves;
+        }
+        publish(board, score, moves, games);
+    }
+    // Stopped before the first move, the last snapshot would still be an older
+    // session's (or empty); the board handed to start() is the right one then
+    publish(board, score, moves, games);
+}
+
+void Autoplay::publish(const Board& board, int score, uint64_t moves, uint64_t games) {
+    AutoplaySnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.board = board;
+    snapshot.score = score;
+    snapshot.moves = moves;
+    snapshot.games = games;
+    snapshots.publish();
+}
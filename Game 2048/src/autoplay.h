@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "policy.h"
+#include "triplebuffer.h"
+
+struct AutoplaySnapshot {
+    Board board;
+    int score = 0;
+    uint64_t moves = 0; // Moves played since autoplay started
+    uint64_t games = 0; // Games finished since autoplay started
+};
+
+// Plays the game with a move policy on its own thread as fast as it can. Every
+// move is published through a triple buffer; the render thread picks up the
+// newest board once per frame and skips everything in between. A finished game
+// is restarted right away, so autoplay doubles as a soak test.
+class Autoplay {
+public:
+    explicit Autoplay(MovePolicy policy) : policy(policy), stopping(false) {}
+    ~Autoplay() { stop(); }
+    Autoplay(const Autoplay&) = delete;
+    Autoplay& operator=(const Autoplay&) = delete;
+
+    void start(const Board& board, int score, uint64_t seed);
+    // Joins the thread, which publishes its final board on the way out, so the
+    // next poll() always returns true and snapshot() is where the game stands
+    void stop();
+    bool running() const { return thread.joinable(); }
+
+    // Render thread: true if a newer snapshot than the last one returned is available
+    bool poll() { return snapshots.update(); }
+    const AutoplaySnapshot& snapshot() const { return snapshots.readBuffer(); }
+
+private:
+    void run(Board board, int score, uint64_t seed);
+    void publish(const Board& board, int score, uint64_t moves, uint64_t games);
+
+    MovePolicy policy;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    TripleBuffer<AutoplaySnapshot> snapshots;
+};
@@ -0,0 +1,316 @@
+// Micro-benchmarks for the game rules: moves per direction, spawning at several
+// fill levels, the game-over check, a full move-spawn-check cycle, the game's own
+// turn with its slide animation and the hint engine's parallel search, each timed
+// over boards taken from seeded greedy games. Needs no SDL, e.g.
+//   g++ -O2 -std=c++17 -pthread bench.cpp board.cpp game.cpp animation.cpp policy.cpp ai.cpp chance.cpp threadpool.cpp alloccount.cpp -o bench
+//   ./bench --json bench.json
+//   ./bench --baseline bench.json --threshold 5
+// Leave NDEBUG undefined so allocations are counted; the counter only costs time
+// when something allocates. Every benchmark must run without touching the heap
+// once warmed up: any allocation is reported and fails the run.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alloccount.h"
+#include "animation.h"
+#include "game.h"
+#include "policy.h"
+
+const int BENCH_ROUNDS = 5; // Timed rounds per benchmark; the median is reported
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp = 0;
+    double opsPerSec = 0;
+    double allocsPerOp = 0;
+    uint64_t ops = 0;
+};
+
+// Boards and moves from seeded greedy play, sorted into the sets the benchmarks need
+struct BenchCorpus {
+    std::vector<Board> boards;     // Every board a move was played from
+    std::vector<int> directions;   // The move greedy play chose from boards[i]
+    std::vector<Board> fillLow;    // 9 tiles or fewer
+    std::vector<Board> fillMid;    // 10 to 17 tiles
+    std::vector<Board> fillHigh;   // 18 to 24 tiles
+    std::vector<Board> fullBoards; // No empty cell, the slow path of isBoardGameOver
+};
+
+static BenchCorpus buildCorpus(uint64_t seed, int count) {
+    BenchCorpus corpus;
+    for (uint64_t game = 0; (int)corpus.boards.size() < count; ++game) {
+        Rng rng(seed, game);
+        Board board;
+        initializeBoard(board, rng);
+        while ((int)corpus.boards.size() < count) {
+            int empty = countEmptyCells(board);
+            int tiles = CELL_COUNT - empty;
+            if (empty == 0) corpus.fullBoards.push_back(board);
+            else if (tiles <= 9) corpus.fillLow.push_back(board);
+            else if (tiles <= 17) corpus.fillMid.push_back(board);
+            else corpus.fillHigh.push_back(board);
+
+            int direction = greedyPolicy(board, rng);
+            if (direction < 0) break;
+            corpus.boards.push_back(board);
+            corpus.directions.push_back(direction);
+            int score = 0;
+            moveBoard(board, direction, score);
+            spawnTiles(board, rng);
+        }
+    }
+    return corpus;
+}
+
+// Runs op(i) for i over [0, size) in passes until a round lasts at least
+// minMs / BENCH_ROUNDS, then reports the median of BENCH_ROUNDS such rounds.
+// op returns a value folded into sink so the compiler cannot drop the work.
+template <class Op>
+static BenchResult runBenchmark(const char* name, size_t size, double minMs, uint64_t& sink, Op op) {
+    typedef std::chrono::steady_clock Clock;
+    BenchResult result;
+    result.name = name;
+    if (size == 0) return result;
+
+    double roundMs = minMs / BENCH_ROUNDS;
+    int passes = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = 0; i < size; ++i) sink += op(i);
+        }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (ms >= roundMs || passes >= (1 << 24)) break;
+        passes = ms <= 0 ? passes * 16 : std::max(passes * 2, (int)(passes * roundMs * 1.2 / ms));
+    }
+
+    double roundNs[BENCH_ROUNDS];
+    uint64_t allocationsBefore = allocationCount();
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        auto start = Clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = 0; i < size; ++i) sink += op(i);
+        }
+        roundNs[round] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    uint64_t allocations = allocationCount() - allocationsBefore;
+
+    uint64_t opsPerRound = (uint64_t)passes * size;
+    std::sort(roundNs, roundNs + BENCH_ROUNDS);
+    result.ops = opsPerRound * BENCH_ROUNDS;
+    result.nsPerOp = roundNs[BENCH_ROUNDS / 2] / opsPerRound;
+    result.opsPerSec = 1e9 / result.nsPerOp;
+    result.allocsPerOp = (double)allocations / result.ops;
+    return result;
+}
+
+static bool writeJson(const char* path, const std::vector<BenchResult>& results, uint64_t seed, int corpusSize) {
+    FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    std::fprintf(file, "{\n  \"seed\": %llu,\n  \"corpus\": %d,\n  \"allocation_counting\": %s,\n  \"benchmarks\": [\n",
+        (unsigned long long)seed, corpusSize, allocationCountingEnabled() ? "true" : "false");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        // One benchmark per line; readBaseline relies on it
+        std::fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f, ", r.name.c_str(), r.nsPerOp, r.opsPerSec);
+        if (allocationCountingEnabled()) std::fprintf(file, "\"allocs_per_op\": %.6f, ", r.allocsPerOp);
+        else std::fprintf(file, "\"allocs_per_op\": null, ");
+        std::fprintf(file, "\"ops\": %llu}%s\n", (unsigned long long)r.ops, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    bool written = std::ferror(file) == 0;
+    return std::fclose(file) == 0 && written;
+}
+
+// Reads the file writeJson produces; allocsPerOp is -1 where it was not counted
+static bool readBaseline(const char* path, std::vector<BenchResult>& baseline) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) return false;
+    char line[512];
+    while (std::fgets(line, sizeof(line), file)) {
+        const char* name = std::strstr(line, "\"name\": \"");
+        const char* ns = std::strstr(line, "\"ns_per_op\": ");
+        if (!name || !ns) continue;
+        name += std::strlen("\"name\": \"");
+        const char* nameEnd = std::strchr(name, '"');
+        if (!nameEnd) continue;
+
+        BenchResult r;
+        r.name.assign(name, nameEnd);
+        r.nsPerOp = std::atof(ns + std::strlen("\"ns_per_op\": "));
+        const char* allocs = std::strstr(line, "\"allocs_per_op\": ");
+        r.allocsPerOp = allocs && allocs[std::strlen("\"allocs_per_op\": ")] != 'n' ? std::atof(allocs + std::strlen("\"allocs_per_op\": ")) : -1;
+        baseline.push_back(r);
+    }
+    std::fclose(file);
+    return true;
+}
+
+static void printUsage() {
+    std::printf("usage: bench [--seed S] [--corpus N] [--min-ms MS] [--filter TEXT] [--json FILE]\n");
+    std::printf("             [--baseline FILE] [--threshold PERCENT]\n");
+    std::printf("--baseline compares with an earlier --json file and exits with 2 when any\n");
+    std::printf("benchmark is more than PERCENT (default 10) slower or allocates more.\n");
+    std::printf("Exits with 3 when a benchmark allocates at all (debug builds only).\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    int corpusSize = 20000;
+    double minMs = 250;
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--seed") == 0 && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--corpus") == 0 && hasValue) corpusSize = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--min-ms") == 0 && hasValue) minMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) filter = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue) jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) baselinePath = argv[++i];
+        else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue) threshold = std::atof(argv[++i]);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (corpusSize <= 0 || minMs <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<BenchResult> baseline;
+    if (baselinePath && !readBaseline(baselinePath, baseline)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", baselinePath);
+        return 1;
+    }
+
+    BenchCorpus corpus = buildCorpus(seed, corpusSize);
+    std::vector<Board> emptyBoards;
+    for (const std::vector<Board>* set : { &corpus.fillLow, &corpus.fillMid, &corpus.fillHigh }) {
+        emptyBoards.insert(emptyBoards.end(), set->begin(), set->end());
+    }
+    std::printf("corpus: %d boards from seed %llu (%d low, %d mid, %d high fill, %d full), allocation counting %s\n",
+        (int)corpus.boards.size(), (unsigned long long)seed, (int)corpus.fillLow.size(), (int)corpus.fillMid.size(),
+        (int)corpus.fillHigh.size(), (int)corpus.fullBoards.size(), allocationCountingEnabled() ? "on" : "off (NDEBUG)");
+
+    // Each benchmark starts from a corpus board, so no op depends on the one before
+    uint64_t sink = 0;
+    std::vector<BenchResult> results;
+    auto run = [&](const char* name, size_t size, auto op) {
+        if (filter && !std::strstr(name, filter)) return;
+        results.push_back(runBenchmark(name, size, minMs, sink, op));
+    };
+    const std::vector<Board>& boards = corpus.boards;
+    const char* moveNames[4] = { "move_up", "move_down", "move_left", "move_right" };
+    for (int direction = 0; direction < 4; ++direction) {
+        run(moveNames[direction], boards.size(), [&](size_t i) {
+            Board board = boards[i];
+            int score = 0;
+            return (uint64_t)moveBoard(board, direction, score) + board.lo + (uint64_t)score;
+        });
+    }
+
+    Rng spawnRng(seed);
+    const std::vector<Board>* spawnSets[3] = { &corpus.fillLow, &corpus.fillMid, &corpus.fillHigh };
+    const char* spawnNames[3] = { "spawn_fill_low", "spawn_fill_mid", "spawn_fill_high" };
+    for (int set = 0; set < 3; ++set) {
+        const std::vector<Board>& spawnBoards = *spawnSets[set];
+        run(spawnNames[set], spawnBoards.size(), [&](size_t i) {
+            Board board = spawnBoards[i];
+            return (uint64_t)spawnTiles(board, spawnRng) + board.lo + board.hi;
+        });
+    }
+
+    run("game_over_full", corpus.fullBoards.size(), [&](size_t i) {
+        return (uint64_t)isBoardGameOver(corpus.fullBoards[i]);
+    });
+    run("game_over_empty", emptyBoards.size(), [&](size_t i) {
+        return (uint64_t)isBoardGameOver(emptyBoards[i]);
+    });
+
+    // What one turn costs: the chosen move, the spawn after it and the game-over check
+    Rng cycleRng(seed);
+    run("cycle", boards.size(), [&](size_t i) {
+        Board board = boards[i];
+        int score = 0;
+        if (moveBoard(board, corpus.directions[i], score)) spawnTiles(board, cycleRng);
+        return (uint64_t)isBoardGameOver(board) + board.lo + (uint64_t)score;
+    });
+
+    // A turn as the main loop plays it: the queued key, the tracked slide and spawn,
+    // every step of the slide animation and the game-over check. main() only asserts
+    // that this path stays off the heap; here an allocation fails the run.
+    Board firstBoard;
+    initializeGame(firstBoard, seed); // Seeds the game's random stream
+    InputQueue inputs;
+    SlideAnimation slide;
+    TileMove tileMoves[CELL_COUNT];
+    run("turn_game", boards.size(), [&](size_t i) {
+        Board board = boards[i];
+        int score = 0;
+        int direction = -1;
+        inputs.push(corpus.directions[i]);
+        inputs.pop(direction);
+        int moveCount = 0;
+        if (slideBoard(board, direction, score, tileMoves, moveCount)) {
+            spawnAfterSlide(board);
+            slide.start(tileMoves, moveCount);
+        }
+        while (slide.active()) slide.advance(ANIMATION_STEP_SECONDS);
+        return (uint64_t)isBoardGameOver(board) + board.lo + (uint64_t)score;
+    });
+
+    // The hint engine's search at depth 1; its root buffers and table are sized on the first call
+    SearchOptions searchOptions;
+    searchOptions.maxDepth = 1;
+    ParallelSearch search(std::max(2, (int)std::thread::hardware_concurrency()));
+    run("search_parallel", std::min<size_t>(boards.size(), 256), [&](size_t i) {
+        return (uint64_t)searchBestMoveParallel(search, boards[i], searchOptions).move;
+    });
+
+    std::printf("%-18s %12s %14s %12s", "benchmark", "ns/op", "ops/sec", "allocs/op");
+    if (!baseline.empty()) std::printf(" %12s %9s", "baseline", "change");
+    std::printf("\n");
+    int regressions = 0;
+    int allocating = 0;
+    for (const BenchResult& r : results) {
+        std::printf("%-18s %12.3f %14.0f %12.4f", r.name.c_str(), r.nsPerOp, r.opsPerSec, r.allocsPerOp);
+        if (r.allocsPerOp > 0) {
+            std::printf("  ALLOCATES");
+            ++allocating;
+        }
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&](const BenchResult& b) { return b.name == r.name; });
+        if (base != baseline.end() && base->nsPerOp > 0) {
+            double change = 100.0 * (r.nsPerOp - base->nsPerOp) / base->nsPerOp;
+            bool slower = change > threshold;
+            bool allocates = allocationCountingEnabled() && base->allocsPerOp >= 0 && r.allocsPerOp > base->allocsPerOp;
+            std::printf(" %12.3f %+8.1f%%%s%s", base->nsPerOp, change, slower ? "  REGRESSION" : "", allocates ? "  MORE ALLOCATIONS" : "");
+            if (slower || allocates) ++regressions;
+        }
+        std::printf("\n");
+    }
+    std::printf("sink %016llx\n", (unsigned long long)sink);
+
+    if (jsonPath && !writeJson(jsonPath, results, seed, (int)corpus.boards.size())) {
+        std::fprintf(stderr, "cannot write %s\n", jsonPath);
+        return 1;
+    }
+    if (allocating > 0) {
+        std::printf("%d benchmark(s) allocate in steady state\n", allocating);
+        return 3;
+    }
+    if (regressions > 0) {
+        std::printf("%d benchmark(s) regressed beyond %.1f%%\n", regressions, threshold);
+        return 2;
+    }
+    return 0;
+}
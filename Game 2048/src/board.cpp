@@ -0,0 +1,294 @@
+#include "board.h"
+
+// Where each tile of a row goes in a left move, 4 bits per source column:
+// bits 0-2 the destination column, bit 3 set when it merged there
+const uint32_t TARGET_BITS = 4;
+const uint32_t TARGET_COLUMN_MASK = 7;
+const uint32_t TARGET_MERGED = 8;
+
+// Slides one packed row towards column 0. As in the original game, a tile is
+// compared with the last tile placed even when that one came from a merge, so
+// 2,2,4 cascades into 8.
+static uint32_t slideRowLeft(uint32_t row, int& rowScore, uint32_t& tileTargets) {
+    uint32_t result = 0;
+    int target = 0;          // Next free column in result
+    int last = 0;            // Exponent at column target - 1
+    uint32_t landed = 0;     // Bit c set for each source column that landed at target - 1
+    uint32_t mergedMask = 0; // Source columns of tiles that took part in a merge
+
+    tileTargets = 0;
+    for (int c = 0; c < GRID_SIZE; ++c) {
+        int exponent = (row >> (c * CELL_BITS)) & CELL_MASK;
+        if (exponent == 0) continue;
+        if (target > 0 && last == exponent) {
+            ++last;
+            result += 1u << ((target - 1) * CELL_BITS); // One more exponent at the last tile
+            rowScore += 1 << last; // Score grows by the merged value
+            tileTargets |= (uint32_t)(target - 1) << (c * TARGET_BITS);
+            landed |= 1u << c;
+            mergedMask |= landed;
+        }
+        else {
+            result |= (uint32_t)exponent << (target * CELL_BITS);
+            tileTargets |= (uint32_t)target << (c * TARGET_BITS);
+            landed = 1u << c;
+            last = exponent;
+            ++target;
+        }
+    }
+    for (int c = 0; c < GRID_SIZE; ++c) {
+        if (mergedMask & (1u << c)) tileTargets |= TARGET_MERGED << (c * TARGET_BITS);
+    }
+    return result;
+}
+
+// Mirrors a packed row: column c swaps with column GRID_SIZE - 1 - c, the middle one stays
+static uint32_t reverseRow(uint32_t row) {
+    return ((row & CELL_MASK) << 20) | ((row & (CELL_MASK << 5)) << 10) | (row & (CELL_MASK << 10)) |
+        ((row >> 10) & (CELL_MASK << 5)) | (row >> 20);
+}
+
+// Rows whose tiles are all below 2^16 fit in the 2^20 entry move tables, which cover
+// every move the game will realistically see. Rows holding a bigger tile fall back
+// to slideRowLeft.
+const uint32_t ROW_MOVED = 1u << 31;      // Flag stored next to the 25 result bits
+
+struct RowMove {
+    uint32_t row;   // Slid row in 5-bit cells, ROW_MOVED set if it differs from the input
+    uint32_t score; // Sum of the merged tile values
+};
+
+// A right move is a left move of the mirrored row
+static RowMove slideRow(uint32_t row, bool right) {
+    int rowScore = 0;
+    uint32_t tileTargets = 0;
+    uint32_t result = right ? reverseRow(slideRowLeft(reverseRow(row), rowScore, tileTargets)) : slideRowLeft(row, rowScore, tileTargets);
+    RowMove move = { result | (result != row ? ROW_MOVED : 0), (uint32_t)rowScore };
+    return move;
+}
+
+// Built once at startup, one table for left and one for right; up and down
+// read them through the transposed board
+struct RowMoveTable {
+    RowMove entries[ROW_TABLE_SIZE];
+
+    explicit RowMoveTable(bool right) {
+        for (uint32_t key = 0; key < ROW_TABLE_SIZE; ++key) {
+            entries[key] = slideRow(tableKeyToRow(key), right);
+        }
+    }
+};
+
+static const RowMoveTable leftMoveTable(false);
+static const RowMoveTable rightMoveTable(true);
+
+static RowMove lookupRow(uint32_t row, bool right) {
+    if (rowFitsTable(row)) {
+        return (right ? rightMoveTable : leftMoveTable).entries[rowToTableKey(row)];
+    }
+    return slideRow(row, right);
+}
+
+// Tile targets of every left move in the row table, so moves that report where
+// each tile went read the same rules as moveBoard
+struct RowTargetTable {
+    uint32_t entries[ROW_TABLE_SIZE];
+
+    RowTargetTable() {
+        for (uint32_t key = 0; key < ROW_TABLE_SIZE; ++key) {
+            int rowScore = 0;
+            slideRowLeft(tableKeyToRow(key), rowScore, entries[key]);
+        }
+    }
+};
+
+static const RowTargetTable rowTargetTable;
+
+static uint32_t lookupRowTargets(uint32_t row) {
+    if (rowFitsTable(row)) return rowTargetTable.entries[rowToTableKey(row)];
+    int rowScore = 0;
+    uint32_t tileTargets = 0;
+    slideRowLeft(row, rowScore, tileTargets);
+    return tileTargets;
+}
+
+// Two adjacent cells of a row, 10 bits, spread into the same column of two rows:
+// the first cell at bit 0, the second at bit ROW_BITS. Shifting an entry by
+// CELL_BITS * r moves both into column r, so rows 0-1 and 2-3 of a transposed
+// board come out already packed as Board.lo and Board.hi lay them out.
+struct CellPairSpreadTable {
+    uint64_t entries[1 << (2 * CELL_BITS)];
+
+    CellPairSpreadTable() {
+        for (uint32_t pair = 0; pair < (1u << (2 * CELL_BITS)); ++pair) {
+            entries[pair] = (uint64_t)(pair & CELL_MASK) | ((uint64_t)(pair >> CELL_BITS) << ROW_BITS);
+        }
+    }
+};
+
+static const CellPairSpreadTable cellPairSpread;
+
+Board transposeBoard(const Board& board) {
+    uint64_t columns01 = 0; // Columns 0 and 1, which become rows 0 and 1
+    uint64_t columns23 = 0;
+    uint32_t column4 = 0;
+    for (int r = 0; r < GRID_SIZE; ++r) {
+        uint32_t row = getRow(board, r);
+        int shift = r * CELL_BITS;
+        columns01 |= cellPairSpread.entries[row & 0x3FF] << shift;
+        columns23 |= cellPairSpread.entries[(row >> 10) & 0x3FF] << shift;
+        column4 |= (row >> 20) << shift;
+    }
+    Board result;
+    result.lo = columns01 | ((uint64_t)(column4 & 0x3FFF) << 50);
+    result.hi = columns23 | ((uint64_t)(column4 >> 14) << 50);
+    return result;
+}
+
+bool moveBoard(Board& board, int direction, int& score) {
+    bool vertical = direction == MOVE_UP || direction == MOVE_DOWN;
+    bool reverse = direction == MOVE_DOWN || direction == MOVE_RIGHT;
+
+    // Up/down work on the transposed board so every direction becomes a row move
+    Board lines = vertical ? transposeBoard(board) : board;
+    Board result;
+    uint32_t movedFlags = 0;
+    for (int r = 0; r < GRID_SIZE; ++r) {
+        uint32_t row = getRow(lines, r);
+        RowMove move = lookupRow(row, reverse);
+        movedFlags |= move.row;
+        score += move.score;
+        setRow(result, r, move.row & ROW_MASK);
+    }
+    if (!(movedFlags & ROW_MOVED)) return false;
+
+    board = vertical ? transposeBoard(result) : result;
+    return true;
+}
+
+// Cell index of position p along line k, counted from the side the tiles slide towards
+static int lineCell(int direction, int line, int position) {
+    switch (direction) {
+    case MOVE_UP: return position * GRID_SIZE + line;
+    case MOVE_DOWN: return (GRID_SIZE - 1 - position) * GRID_SIZE + line;
+    case MOVE_LEFT: return line * GRID_SIZE + position;
+    default: return line * GRID_SIZE + (GRID_SIZE - 1 - position);
+    }
+}
+
+bool moveBoardTracked(Board& board, int direction, int& score, TileMove moves[CELL_COUNT], int& moveCount) {
+    bool vertical = direction == MOVE_UP || direction == MOVE_DOWN;
+    bool reverse = direction == MOVE_DOWN || direction == MOVE_RIGHT;
+
+    // Each line read in the order its tiles slide, so it is a left move in the tables
+    Board lines = vertical ? transposeBoard(board) : board;
+    moveCount = 0;
+    for (int line = 0; line < GRID_SIZE; ++line) {
+        uint32_t row = getRow(lines, line);
+        if (reverse) row = reverseRow(row);
+        uint32_t tileTargets = lookupRowTargets(row);
+        for (int position = 0; position < GRID_SIZE; ++position) {
+            int exponent = (row >> (position * CELL_BITS)) & CELL_MASK;
+            if (exponent == 0) continue;
+            uint32_t target = tileTargets >> (position * TARGET_BITS);
+            TileMove& move = moves[moveCount++];
+            move.from = (uint8_t)lineCell(direction, line, position);
+            move.to = (uint8_t)lineCell(direction, line, (int)(target & TARGET_COLUMN_MASK));
+            move.exponent = (uint8_t)exponent;
+            move.merged = (target & TARGET_MERGED) ? 1 : 0;
+        }
+    }
+    return moveBoard(board, direction, score);
+}
+
+void initializeBoard(Board& board, Rng& rng) {
+    board = Board();
+    spawnTiles(board, rng);
+    spawnTiles(board, rng);
+}
+
+// Bits 0, 5, 10, 15 and 20: the lowest bit of every cell in a packed row
+const uint32_t ROW_LOW_BITS = 0x108421;
+
+// Lowest bit of each cell of a packed row that is zero
+static uint32_t zeroCells(uint32_t row) {
+    uint32_t any = row | (row >> 1) | (row >> 2) | (row >> 3) | (row >> 4);
+    return ~any & ROW_LOW_BITS;
+}
+
+// Gathers bits 0, 5, 10, 15, 20 into bits 0-4. The shifted copies never overlap,
+// so the multiply has no carries.
+static uint32_t gatherCellBits(uint32_t bits) {
+    return ((bits * 0x111110u) >> 20) & 0x1F;
+}
+
+int selectBit(uint32_t mask, int n) {
+    // Skip whole bytes by popcount, then walk at most 7 bits of the last byte
+    int base = 0;
+    for (;;) {
+        int count = popCount(mask & 0xFF);
+        if (n < count) break;
+        n -= count;
+        mask >>= 8;
+        base += 8;
+    }
+    while (n-- > 0) mask &= mask - 1;
+    uint32_t lowest = mask & (0u - mask);
+    int bit = 0;
+    while (lowest >>= 1) ++bit;
+    return base + bit;
+}
+
+uint32_t emptyCellMask(const Board& board) {
+    uint32_t mask = 0;
+    for (int r = 0; r < GRID_SIZE; ++r) {
+        mask |= gatherCellBits(zeroCells(getRow(board, r))) << (r * GRID_SIZE);
+    }
+    return mask;
+}
+
+int spawnTiles(Board& board, Rng& rng) {
+    // Every move places a forced 2 and one extra tile from {2, 4, 8, 16, 32}.
+    // With a single empty cell only the forced 2 is placed; a full board gets nothing.
+    uint32_t empty = emptyCellMask(board);
+    int emptyCount = popCount(empty);
+    if (emptyCount == 0) return 0;
+
+    int cell = selectBit(empty, (int)rng.below(emptyCount));
+    setCell(board, cell / GRID_SIZE, cell % GRID_SIZE, 1);
+    if (emptyCount == 1) return 1;
+
+    empty &= ~(1u << cell);
+    int extraCell = selectBit(empty, (int)rng.below(emptyCount - 1));
+    setCell(board, extraCell / GRID_SIZE, extraCell % GRID_SIZE, 1 + (int)rng.below(5));
+    return 2;
+}
+
+bool isBoardGameOver(const Board& board) {
+    uint32_t previous = 0;
+    for (int r = 0; r < GRID_SIZE; ++r) {
+        uint32_t row = getRow(board, r);
+        if (zeroCells(row)) return false;
+        // Equal horizontal neighbours: cells 0-3 compared with the cell to their right
+        if (zeroCells(row ^ (row >> CELL_BITS)) & (ROW_LOW_BITS >> CELL_BITS)) return false;
+        // Equal vertical neighbours
+        if (r > 0 && zeroCells(row ^ previous)) return false;
+        previous = row;
+    }
+    return true;
+}
+
+int countEmptyCells(const Board& board) {
+    return popCount(emptyCellMask(board));
+}
+
+int maxTileExponent(const Board& board) {
+    int best = 0;
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            int exponent = getCell(board, i, j);
+            if (exponent > best) best = exponent;
+        }
+    }
+    return best;
+}
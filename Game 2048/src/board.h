@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include "rng.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Constants
+const int GRID_SIZE = 5;
+const int CELL_COUNT = GRID_SIZE * GRID_SIZE;
+const int CELL_BITS = 5;                          // Each cell holds a tile exponent (0 = empty, 1 = 2, 2 = 4, ...)
+const int ROW_BITS = GRID_SIZE * CELL_BITS;       // 25 bits per packed row
+const uint32_t CELL_MASK = (1u << CELL_BITS) - 1;
+const uint32_t ROW_MASK = (1u << ROW_BITS) - 1;
+
+// Move directions, same numbering as the arrow key handling in main()
+const int MOVE_UP = 0;
+const int MOVE_DOWN = 1;
+const int MOVE_LEFT = 2;
+const int MOVE_RIGHT = 3;
+
+// The 5x5 grid packed into 128 bits.
+// Rows 0-1 live in the low 50 bits of lo, rows 2-3 in the low 50 bits of hi.
+// Row 4 is split: its low 14 bits are lo[50..63] and its high 11 bits are hi[50..60].
+// Inside a row, column c occupies bits [5c, 5c + 5).
+struct Board {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+};
+
+// Where one tile went during a move; cells are numbered row * GRID_SIZE + col.
+// Tiles that stay put are listed too, with from == to.
+struct TileMove {
+    uint8_t from;
+    uint8_t to;
+    uint8_t exponent; // Of the tile before the move
+    uint8_t merged;   // 1 for every tile that merged at to
+};
+
+inline bool operator==(const Board& a, const Board& b) { return a.lo == b.lo && a.hi == b.hi; }
+inline bool operator!=(const Board& a, const Board& b) { return !(a == b); }
+
+inline uint32_t getRow(const Board& board, int row) {
+    if (row < 2) return (uint32_t)(board.lo >> (row * ROW_BITS)) & ROW_MASK;
+    if (row < 4) return (uint32_t)(board.hi >> ((row - 2) * ROW_BITS)) & ROW_MASK;
+    return (uint32_t)(board.lo >> 50) | ((uint32_t)(board.hi >> 50) << 14);
+}
+
+inline void setRow(Board& board, int row, uint32_t bits) {
+    if (row < 2) {
+        int shift = row * ROW_BITS;
+        board.lo = (board.lo & ~((uint64_t)ROW_MASK << shift)) | ((uint64_t)bits << shift);
+    }
+    else if (row < 4) {
+        int shift = (row - 2) * ROW_BITS;
+        board.hi = (board.hi & ~((uint64_t)ROW_MASK << shift)) | ((uint64_t)bits << shift);
+    }
+    else {
+        board.lo = (board.lo & ((1ull << 50) - 1)) | ((uint64_t)(bits & 0x3FFF) << 50);
+        board.hi = (board.hi & ((1ull << 50) - 1)) | ((uint64_t)(bits >> 14) << 50);
+    }
+}
+
+inline int getCell(const Board& board, int row, int col) {
+    return (getRow(board, row) >> (col * CELL_BITS)) & CELL_MASK;
+}
+
+inline void setCell(Board& board, int row, int col, int exponent) {
+    uint32_t bits = getRow(board, row);
+    bits &= ~(CELL_MASK << (col * CELL_BITS));
+    bits |= (uint32_t)exponent << (col * CELL_BITS);
+    setRow(board, row, bits);
+}
+
+inline int popCount(uint32_t x) {
+#ifdef _MSC_VER
+    return (int)__popcnt(x);
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+inline int exponentToValue(int exponent) {
+    return exponent == 0 ? 0 : 1 << exponent;
+}
+
+inline int valueToExponent(int value) {
+    int exponent = 0;
+    while (value > 1) {
+        value >>= 1;
+        ++exponent;
+    }
+    return exponent;
+}
+
+// Position of the n-th (0-based) set bit of mask; n must be below popCount(mask)
+int selectBit(uint32_t mask, int n);
+
+// Per-row lookup tables are indexed by the row squeezed to 4 bits per cell,
+// which works for every row whose tiles are all below 2^16
+const uint32_t ROW_TABLE_SIZE = 1u << (GRID_SIZE * 4);
+const uint32_t ROW_HIGH_BITS = 0x1084210; // Bit 4 of every 5-bit cell
+
+inline bool rowFitsTable(uint32_t row) {
+    return (row & ROW_HIGH_BITS) == 0;
+}
+
+inline uint32_t rowToTableKey(uint32_t row) {
+    return (row & 0xF) | ((row >> 1) & 0xF0) | ((row >> 2) & 0xF00) | ((row >> 3) & 0xF000) | ((row >> 4) & 0xF0000);
+}
+
+inline uint32_t tableKeyToRow(uint32_t key) {
+    return (key & 0xF) | ((key & 0xF0) << 1) | ((key & 0xF00) << 2) | ((key & 0xF000) << 3) | ((key & 0xF0000) << 4);
+}
+
+// Board operations
+void initializeBoard(Board& board, Rng& rng);
+Board transposeBoard(const Board& board);
+bool moveBoard(Board& board, int direction, int& score);
+// moveBoard that also fills moves[0..moveCount) with where every tile on the board went
+bool moveBoardTracked(Board& board, int direction, int& score, TileMove moves[CELL_COUNT], int& moveCount);
+uint32_t emptyCellMask(const Board& board); // Bit (row * GRID_SIZE + col) set for each empty cell
+int spawnTiles(Board& board, Rng& rng);     // Returns how many tiles were placed (0, 1 or 2)
+bool isBoardGameOver(const Board& board);
+int countEmptyCells(const Board& board);
+int maxTileExponent(const Board& board);
@@ -0,0 +1,83 @@
+#include "chance.h"
+#include <algorithm>
+
+int exactChanceOutcomeCount(int emptyCount) {
+    if (emptyCount <= 1) return 1;
+    // Two 2s on cells {i, j} are the same board whichever was the forced one
+    return emptyCount * (emptyCount - 1) / 2 + emptyCount * (emptyCount - 1) * 4;
+}
+
+static Board placeTiles(const Board& board, int cell, int extraCell, int extraExponent) {
+    Board result = board;
+    setCell(result, cell / GRID_SIZE, cell % GRID_SIZE, 1);
+    setCell(result, extraCell / GRID_SIZE, extraCell % GRID_SIZE, extraExponent);
+    return result;
+}
+
+static bool boardLess(const ChanceOutcome& a, const ChanceOutcome& b) {
+    return a.board.hi != b.board.hi ? a.board.hi < b.board.hi : a.board.lo < b.board.lo;
+}
+
+static int enumerateExact(const Board& board, uint32_t empty, int emptyCount, ChanceOutcome* outcomes) {
+    double pairProbability = 1.0 / (emptyCount * (emptyCount - 1));
+    int count = 0;
+    for (uint32_t first = empty; first; first &= first - 1) {
+        int cell = selectBit(first, 0);
+        for (uint32_t second = empty & ~(1u << cell); second; second &= second - 1) {
+            int extraCell = selectBit(second, 0);
+            // 2 + 2 is written once, from the ordered pair with the lower forced cell
+            if (extraCell > cell) {
+                outcomes[count++] = { placeTiles(board, cell, extraCell, 1), pairProbability * 2 / 5 };
+            }
+            for (int exponent = 2; exponent <= 5; ++exponent) {
+                outcomes[count++] = { placeTiles(board, cell, extraCell, exponent), pairProbability / 5 };
+            }
+        }
+    }
+    return count;
+}
+
+static int enumerateSampled(const Board& board, uint32_t empty, int emptyCount, ChanceOutcome* outcomes, int budget, uint64_t sampleSeed) {
+    int pairs = std::max(1, budget / 5);
+    double sampleProbability = 1.0 / (pairs * 5);
+    Rng rng(sampleSeed);
+    int count = 0;
+    for (int sample = 0; sample < pairs; ++sample) {
+        int cell = selectBit(empty, (int)rng.below(emptyCount));
+        int extraCell = selectBit(empty & ~(1u << cell), (int)rng.below(emptyCount - 1));
+        for (int exponent = 1; exponent <= 5; ++exponent) {
+            outcomes[count++] = { placeTiles(board, cell, extraCell, exponent), sampleProbability };
+        }
+    }
+
+    // Repeated draws of the same board become one weighted outcome
+    std::sort(outcomes, outcomes + count, boardLess);
+    int merged = 0;
+    for (int i = 0; i < count; ++i) {
+        if (merged > 0 && outcomes[merged - 1].board == outcomes[i].board) {
+            outcomes[merged - 1].probability += outcomes[i].probability;
+        }
+        else {
+            outcomes[merged++] = outcomes[i];
+        }
+    }
+    return merged;
+}
+
+int generateChanceOutcomes(const Board& board, ChanceOutcome* outcomes, int budget, uint64_t sampleSeed) {
+    uint32_t empty = emptyCellMask(board);
+    int emptyCount = popCount(empty);
+    if (emptyCount <= 1) {
+        // Only the forced 2 fits, or nothing does
+        outcomes[0] = { board, 1.0 };
+        if (emptyCount == 1) {
+            int cell = selectBit(empty, 0);
+            setCell(outcomes[0].board, cell / GRID_SIZE, cell % GRID_SIZE, 1);
+        }
+        return 1;
+    }
+    if (budget > 0 && exactChanceOutcomeCount(emptyCount) > budget) {
+        return enumerateSampled(board, empty, emptyCount, outcomes, budget, sampleSeed);
+    }
+    return enumerateExact(board, empty, emptyCount, outcomes);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include "board.h"
+
+// Chance-node generator for the double spawn: a forced 2 on one empty cell, then an
+// extra tile from {2, 4, 8, 16, 32} on another. With E empty cells that is
+// E * (E - 1) * 5 raw outcomes, many of which lead to the same board.
+
+struct ChanceOutcome {
+    Board board;
+    double probability;
+};
+
+// Upper bound on the outcomes generateChanceOutcomes writes, for sizing buffers
+const int MAX_CHANCE_OUTCOMES = CELL_COUNT * (CELL_COUNT - 1) / 2 + CELL_COUNT * (CELL_COUNT - 1) * 4;
+
+// Writes the distinct boards reachable by spawning on board, with probabilities
+// summing to 1, and returns how many were written.
+// If the exact set is larger than budget (and budget > 0), cell pairs are sampled
+// instead: about budget / 5 pairs, each expanded over all 5 extra tiles, drawn from
+// a stream seeded by sampleSeed so the same board always gets the same sample.
+int generateChanceOutcomes(const Board& board, ChanceOutcome* outcomes, int budget, uint64_t sampleSeed);
+
+// Number of outcomes the exact enumeration produces for a board with emptyCount empty cells
+int exactChanceOutcomeCount(int emptyCount);
@@ -0,0 +1,45 @@
+#include "framestats.h"
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) return 0;
+    ULARGE_INTEGER kernelTime = { { kernel.dwLowDateTime, kernel.dwHighDateTime } };
+    ULARGE_INTEGER userTime = { { user.dwLowDateTime, user.dwHighDateTime } };
+    return (kernelTime.QuadPart + userTime.QuadPart) * 1e-7; // 100 ns units
+#else
+    timespec now;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) return 0;
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+FrameStats::FrameStats(uint32_t nowMs, uint32_t intervalMs)
+    : intervalMs(intervalMs), startMs(nowMs), periodStartMs(nowMs), startCpu(processCpuSeconds()), periodStartCpu(startCpu) {
+}
+
+static void printStats(const char* label, uint64_t frames, uint64_t wakeups, double seconds, double cpuSeconds) {
+    if (seconds <= 0) return;
+    std::cout << label << ": " << frames << " frames (" << frames / seconds << " fps), "
+        << wakeups << " wakeups, cpu " << 100.0 * cpuSeconds / seconds << "%" << std::endl;
+}
+
+void FrameStats::update(uint32_t nowMs) {
+    if (nowMs - periodStartMs < intervalMs) return;
+    double cpu = processCpuSeconds();
+    printStats("last period", frames - periodFrames, wakeups - periodWakeups, (nowMs - periodStartMs) / 1000.0, cpu - periodStartCpu);
+    periodStartMs = nowMs;
+    periodStartCpu = cpu;
+    periodFrames = frames;
+    periodWakeups = wakeups;
+}
+
+void FrameStats::printTotals(uint32_t nowMs) const {
+    printStats("session", frames, wakeups, (nowMs - startMs) / 1000.0, processCpuSeconds() - startCpu);
+}
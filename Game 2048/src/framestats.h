@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+// Seconds of CPU time used by this process so far, summed over all threads
+double processCpuSeconds();
+
+// Counts frames presented and main-loop wakeups and prints them together with
+// the CPU share the process used, so idle cost can be checked.
+class FrameStats {
+public:
+    explicit FrameStats(uint32_t nowMs, uint32_t intervalMs = 5000);
+
+    void frameRendered() { ++frames; }
+    void loopWoke() { ++wakeups; }
+
+    // Prints and restarts the period once intervalMs has passed
+    void update(uint32_t nowMs);
+    void printTotals(uint32_t nowMs) const;
+
+private:
+    uint32_t intervalMs;
+    uint32_t startMs;
+    uint32_t periodStartMs;
+    double startCpu;
+    double periodStartCpu;
+    uint64_t frames = 0;
+    uint64_t wakeups = 0;
+    uint64_t periodFrames = 0;
+    uint64_t periodWakeups = 0;
+};
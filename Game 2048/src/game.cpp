@@ -0,0 +1,17 @@
+#include "game.h"
+
+// Random stream for the interactive game, reseeded by every initializeGame
+static Rng gameRng;
+
+void initializeGame(Board& board, uint64_t seed, uint64_t stream) {
+    gameRng = Rng(seed, stream);
+    initializeBoard(board, gameRng);
+}
+
+bool slideBoard(Board& board, int direction, int& score, TileMove moves[CELL_COUNT], int& moveCount) {
+    return moveBoardTracked(board, direction, score, moves, moveCount);
+}
+
+void spawnAfterSlide(Board& board) {
+    spawnTiles(board, gameRng);
+}
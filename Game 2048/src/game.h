@@ -0,0 +1,15 @@
+#pragma once
+#include "board.h"
+
+// Game rules for the board held by main(). They only depend on the C++ standard
+// library, so the headless tools can link them without SDL.
+// Starts a game on the random stream Rng(seed, stream); a replay of it needs only
+// these and the moves played.
+void initializeGame(Board& board, uint64_t seed, uint64_t stream = 0);
+// A move is a slide and, if the board changed, a spawn. They are separate calls so
+// the main loop can time each one.
+// Slides the tiles; false if the board did not change. moves lists where every
+// tile went, for the animation.
+bool slideBoard(Board& board, int direction, int& score, TileMove moves[CELL_COUNT], int& moveCount);
+// Places the tiles that follow a slide that changed the board
+void spawnAfterSlide(Board& board);
@@ -0,0 +1,73 @@
+#include "hint.h"
+#include <utility>
+
+HintEngine::HintEngine(int searchThreads, int maxDepth, std::function<void()> onPublish)
+    : search(searchThreads), maxDepth(maxDepth), onPublish(std::move(onPublish)), mailbox(0) {
+    worker = std::thread(&HintEngine::run, this);
+}
+
+HintEngine::~HintEngine() {
+    stop();
+}
+
+void HintEngine::stop() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+        search.cancel = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void HintEngine::setBoard(const Board& board) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingBoard = board;
+        shownGeneration = ++requested;
+        // Abandon whatever the worker is searching right now. Raised under the lock,
+        // so it cannot land after the worker has taken this board and cleared it.
+        search.cancel = true;
+    }
+    wake.notify_one();
+}
+
+int HintEngine::bestMove(int* depth) const {
+    uint64_t message = mailbox.load(std::memory_order_acquire);
+    if ((message >> 16) != shownGeneration) return -1;
+    if (depth) *depth = (int)((message >> 8) & 0xFF);
+    return (int)(message & 0xFF) - 1;
+}
+
+void HintEngine::run() {
+    uint64_t searched = 0;
+    for (;;) {
+        Board board;
+        uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quitting || requested != searched; });
+            if (quitting) return;
+            board = pendingBoard;
+            generation = requested;
+            search.cancel = false;
+        }
+        searched = generation;
+
+        // Deepen one level at a time so each finished depth reaches the UI right away;
+        // the shared table makes the repeated shallow levels cheap
+        SearchOptions options;
+        for (int depth = 1; depth <= maxDepth; ++depth) {
+            options.maxDepth = depth;
+            SearchResult result = searchBestMoveParallel(search, board, options);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (quitting || requested != generation) break;
+            }
+            if (result.move < 0) break; // Game over, nothing to hint
+            mailbox.store(generation << 16 | (uint64_t)depth << 8 | (uint64_t)(result.move + 1), std::memory_order_release);
+            if (onPublish) onPublish();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "ai.h"
+
+// Searches the board on screen on a background thread and streams the best move
+// found so far to the UI. Every call to setBoard cancels the running search and
+// starts over on the new board, deepening until maxDepth and then going idle.
+class HintEngine {
+public:
+    // onPublish runs on the worker thread after each new best move, so the UI can
+    // sleep until there is something to show
+    HintEngine(int searchThreads, int maxDepth, std::function<void()> onPublish = nullptr);
+    ~HintEngine();
+    HintEngine(const HintEngine&) = delete;
+    HintEngine& operator=(const HintEngine&) = delete;
+
+    void setBoard(const Board& board);
+
+    // Cancels the search and joins the worker; onPublish is not called afterwards
+    void stop();
+
+    // Best move for the last board passed to setBoard, -1 until the first depth finishes.
+    // Never blocks: it is a single atomic load.
+    int bestMove(int* depth = nullptr) const;
+
+private:
+    void run();
+
+    ParallelSearch search;
+    int maxDepth;
+    std::function<void()> onPublish;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    Board pendingBoard;
+    uint64_t requested = 0; // Generation of pendingBoard, guarded by mutex
+    bool quitting = false;
+
+    // Lock-free mailbox: generation << 16 | depth << 8 | (move + 1)
+    std::atomic<uint64_t> mailbox;
+    uint64_t shownGeneration = 0; // UI thread's copy of the latest generation
+};
@@ -0,0 +1,138 @@
+#include "imagecache.h"
+#include <cstdio>
+#include <cstring>
+
+const char CACHE_MAGIC[8] = { '2', '0', '4', '8', 'R', 'G', 'B', '1' };
+const uint32_t MAX_CACHED_IMAGES = 1024; // Anything larger means the file is damaged
+const uint32_t MAX_CACHED_SIDE = 4096;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct CacheEntry {
+    uint64_t hash;
+    uint32_t width;
+    uint32_t height;
+};
+
+uint64_t hashBytes(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void ImageCache::load() {
+    SDL_RWops* file = SDL_RWFromFile(path.c_str(), "rb");
+    if (!file) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Sint64 fileSize = SDL_RWsize(file);
+    CacheHeader header;
+    bool valid = fileSize >= (Sint64)sizeof(header) && SDL_RWread(file, &header, sizeof(header), 1) == 1 &&
+        std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && header.count <= MAX_CACHED_IMAGES;
+    uint64_t remaining = valid ? (uint64_t)fileSize - sizeof(header) : 0;
+    std::vector<CacheEntry> index(valid ? header.count : 0);
+    if (valid && !index.empty()) {
+        valid = remaining >= index.size() * sizeof(CacheEntry) && SDL_RWread(file, index.data(), sizeof(CacheEntry), index.size()) == index.size();
+        remaining -= valid ? index.size() * sizeof(CacheEntry) : 0;
+    }
+    for (size_t i = 0; valid && i < index.size(); ++i) {
+        // Nothing is allocated for an entry the rest of the file cannot hold
+        uint64_t extent = (uint64_t)index[i].width * index[i].height * 4;
+        valid = index[i].width > 0 && index[i].width <= MAX_CACHED_SIDE && index[i].height > 0 && index[i].height <= MAX_CACHED_SIDE &&
+            extent <= remaining;
+        if (!valid) break;
+        remaining -= extent;
+        Entry& entry = entries[index[i].hash];
+        entry.width = (int)index[i].width;
+        entry.height = (int)index[i].height;
+        entry.pixels.resize((size_t)extent);
+        valid = SDL_RWread(file, entry.pixels.data(), entry.pixels.size(), 1) == 1;
+    }
+    SDL_RWclose(file);
+    // Bytes left over mean the index does not describe this file either
+    if (!valid || remaining != 0) {
+        entries.clear();
+        dirty = true;
+    }
+}
+
+SDL_Surface* ImageCache::find(uint64_t hash) {
+    const Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(hash);
+        if (found == entries.end()) return nullptr;
+        found->second.used = true;
+        entry = &found->second;
+    }
+    // The copy runs unlocked: add() never replaces an entry and only save()
+    // erases any, so the pixels stay put until the loader has finished.
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, entry->width, entry->height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return nullptr;
+    for (int y = 0; y < entry->height; ++y) {
+        std::memcpy((unsigned char*)surface->pixels + (size_t)y * surface->pitch, &entry->pixels[(size_t)y * entry->width * 4], (size_t)entry->width * 4);
+    }
+    return surface;
+}
+
+void ImageCache::add(uint64_t hash, SDL_Surface* surface) {
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) return;
+    Entry entry;
+    entry.width = rgba->w;
+    entry.height = rgba->h;
+    entry.pixels.resize((size_t)rgba->w * rgba->h * 4);
+    for (int y = 0; y < rgba->h; ++y) {
+        std::memcpy(&entry.pixels[(size_t)y * rgba->w * 4], (unsigned char*)rgba->pixels + (size_t)y * rgba->pitch, (size_t)rgba->w * 4);
+    }
+    SDL_FreeSurface(rgba);
+    entry.used = true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.emplace(hash, std::move(entry)).second) dirty = true; // Same hash, same pixels
+}
+
+bool ImageCache::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.used) {
+            ++it;
+            continue;
+        }
+        it = entries.erase(it);
+        dirty = true;
+    }
+    if (!dirty) return true;
+
+    // Write next to the old file and swap it in, so a crash never leaves half a cache
+    std::string temporary = path + ".tmp";
+    SDL_RWops* file = SDL_RWFromFile(temporary.c_str(), "wb");
+    if (!file) return false;
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.count = (uint32_t)entries.size();
+    bool written = SDL_RWwrite(file, &header, sizeof(header), 1) == 1;
+    for (const auto& pair : entries) {
+        CacheEntry index = { pair.first, (uint32_t)pair.second.width, (uint32_t)pair.second.height };
+        written = written && SDL_RWwrite(file, &index, sizeof(index), 1) == 1;
+    }
+    for (const auto& pair : entries) {
+        written = written && SDL_RWwrite(file, pair.second.pixels.data(), pair.second.pixels.size(), 1) == 1;
+    }
+    written = SDL_RWclose(file) == 0 && written; // Close flushes, so it can fail too
+    if (!written) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    std::remove(path.c_str());
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) return false;
+    dirty = false;
+    return true;
+}
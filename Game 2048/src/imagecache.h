@@ -0,0 +1,51 @@
+#pragma once
+#include <SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// FNV-1a over the bytes of a packed file; keys the image cache
+uint64_t hashBytes(const void* data, size_t size);
+
+// Decoded RGBA pixels of packed images, kept in one file (under SDL_GetPrefPath
+// in the game) so later launches skip PNG decoding. Entries are keyed by the
+// hash of the packed bytes: an image that changed simply misses, is decoded
+// again and replaces the stale entry when the file is saved. Entries nobody
+// looked up are dropped on save.
+//
+//   "2048RGB1", uint32 count, uint32 reserved
+//   count x { uint64 hash, uint32 width, uint32 height }
+//   pixels of every entry in the same order, width * height * 4 bytes each
+class ImageCache {
+public:
+    // Nothing is read yet; the image loader calls load() on its own thread
+    explicit ImageCache(const std::string& path) : path(path) {}
+
+    // Reads the cache file if it exists. A damaged or truncated file is treated
+    // as empty and replaced on the next save.
+    void load();
+
+    // Both are safe to call from several decode threads at once, but not
+    // together with save()
+    SDL_Surface* find(uint64_t hash);             // New RGBA32 surface, nullptr on a miss
+    void add(uint64_t hash, SDL_Surface* surface); // Copies the pixels of a freshly decoded image
+
+    // Rewrites the file if anything was added or dropped since it was read
+    bool save();
+
+private:
+    struct Entry {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels; // RGBA32, tightly packed rows
+        bool used = false;
+    };
+
+    std::string path;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    bool dirty = false;
+};
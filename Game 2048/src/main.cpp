@@ -1,337 +1,492 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
 #include <iostream>
 #include <vector>
-#include <cstdlib>
-#include <ctime>
 #include <string>
-#include <unordered_map>
+#include <thread>
+#include "alloccount.h"
+#include "assetloader.h"
+#include "autoplay.h"
+#include "framestats.h"
+#include "game.h"
+#include "hint.h"
+#include "profiler.h"
+#include "render.h"
+#include "replay.h"
+#include "text.h"
 
 // Constants
-const int GRID_SIZE = 5;
-const int TILE_SIZE = 100;
-const int TILE_PADDING = 10;
-const int BORDER_THICKNESS = 10; // Uniform border thickness
-const int EXTRA_WIDTH = 250; // Extra width for additional area
-const int WINDOW_WIDTH = GRID_SIZE * TILE_SIZE + EXTRA_WIDTH;
-const int WINDOW_HEIGHT = GRID_SIZE * TILE_SIZE;
-
-// Function prototypes
-void initializeGrid(std::vector<std::vector<int>>& grid);
-void renderGrid(SDL_Renderer* renderer, const std::vector<std::vector<int>>& grid, std::unordered_map<int, SDL_Texture*>& tileTextures);
-void spawnTile(std::vector<std::vector<int>>& grid);
-bool moveAndMergeTiles(std::vector<std::vector<int>>& grid, int direction, int& score);
-bool isGameOver(const std::vector<std::vector<int>>& grid);
-SDL_Texture* loadTexture(const std::string& path, SDL_Renderer* renderer);
-std::unordered_map<int, SDL_Texture*> loadTileTextures(SDL_Renderer* renderer);
-SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color);
+const int HINT_DEPTH = 4; // The hint engine deepens up to this many moves, then idles
+const int AUTOPLAY_DEPTH = 1; // Shallow search keeps autoplay at thousands of moves per second
+const int AUTOPLAY_WAIT_MS = 1; // Autoplay has not published a new board since the last frame
+const int LOADING_WAIT_MS = 5; // Event polling interval while the tile images decode
+const char* const ASSET_PACK_NAME = "assets.pak"; // Written by packassets, see packassets.cpp
+const char* const IMAGE_CACHE_NAME = "images.cache"; // Decoded tile pixels, kept in the per-user pref path
+
+// The asset pack sits next to the executable; fall back to the working directory
+static bool openAssetPack(AssetPack& pack) {
+    char* basePath = SDL_GetBasePath();
+    bool opened = false;
+    if (basePath) {
+        std::string path = std::string(basePath) + ASSET_PACK_NAME;
+        opened = pack.open(path.c_str());
+        SDL_free(basePath);
+    }
+    return opened || pack.open(ASSET_PACK_NAME);
+}
+
+// Closes what main() created, in reverse order; null handles were never created.
+// The quit calls are safe even for a library whose init failed.
+static void shutDown(TTF_Font* font, SDL_Renderer* renderer, SDL_Window* window) {
+    if (font) TTF_CloseFont(font);
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (window) SDL_DestroyWindow(window);
+    IMG_Quit();
+    TTF_Quit();
+    SDL_Quit();
+}
+
+static double millisecondsSince(Uint64 startCounter) {
+    return (SDL_GetPerformanceCounter() - startCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+}
 
 int main(int argc, char* argv[]) {
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+
+    // --no-image-cache decodes every PNG, to compare cold and warm startup.
+    // --trace FILE writes every frame phase as a Chrome trace_event file on exit.
+    // --record FILE saves the game as a replay on exit; --replay FILE plays one back.
+    // --frame-stats prints frames, wakeups and CPU share every few seconds, not just on exit.
+    bool useImageCache = true;
+    const char* tracePath = nullptr;
+    const char* recordPath = nullptr;
+    const char* playbackPath = nullptr;
+    bool printFrameStats = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--no-image-cache") == 0) useImageCache = false;
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) playbackPath = argv[++i];
+        else if (std::strcmp(argv[i], "--frame-stats") == 0) printFrameStats = true;
+    }
+
+    // The game being recorded, or the one played back
+    Replay replay;
+    if (playbackPath) {
+        const char* error = nullptr;
+        if (!replay.load(playbackPath, error)) {
+            std::cerr << "Failed to load replay " << playbackPath << ": " << error << std::endl;
+            return -1;
+        }
+        recordPath = nullptr;
+    }
+#ifndef NDEBUG
+    if (tracePath) mainProfiler().startTrace();
+#else
+    if (tracePath) {
+        std::cerr << "--trace needs a debug build; the profiler is compiled out with NDEBUG" << std::endl;
+        tracePath = nullptr;
+    }
+#endif
+
     // Initialize SDL_ttf
     if (TTF_Init() == -1) {
         std::cerr << "Failed to initialize SDL_ttf: " << TTF_GetError() << std::endl;
-        SDL_Quit();
+        shutDown(nullptr, nullptr, nullptr);
+        return -1;
+    }
+    // Every image and the font come from one memory-mapped archive
+    AssetPack assets;
+    if (!openAssetPack(assets)) {
+        std::cerr << "Failed to open " << ASSET_PACK_NAME << std::endl;
+        shutDown(nullptr, nullptr, nullptr);
         return -1;
     }
+
     // Load the font
-    TTF_Font* font = TTF_OpenFont("E:/2048-font/2048-font.ttf", 24); // Replace with your actual font path
+    SDL_RWops* fontStream = openPackedAsset(assets, "2048-font.ttf");
+    TTF_Font* font = fontStream ? TTF_OpenFontRW(fontStream, 1, 24) : nullptr;
     if (!font) {
         std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        TTF_Quit();
-        SDL_Quit();
+        shutDown(nullptr, nullptr, nullptr);
         return -1;
     }
 
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "Failed to initialize SDL: " << SDL_GetError() << std::endl;
+        shutDown(font, nullptr, nullptr);
         return -1;
     }
 
     if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
         std::cerr << "Failed to initialize SDL_image: " << IMG_GetError() << std::endl;
-        SDL_Quit();
+        shutDown(font, nullptr, nullptr);
         return -1;
     }
 
     SDL_Window* window = SDL_CreateWindow("2048 Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
     if (!window) {
         std::cerr << "Failed to create window: " << SDL_GetError() << std::endl;
-        SDL_Quit();
+        shutDown(font, nullptr, nullptr);
         return -1;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Present at the display refresh rate; autoplay runs on its own thread, not per frame
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
         std::cerr << "Failed to create renderer: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+        shutDown(font, nullptr, window);
         return -1;
     }
 
-    std::unordered_map<int, SDL_Texture*> tileTextures = loadTileTextures(renderer);
-    std::vector<std::vector<int>> grid(GRID_SIZE, std::vector<int>(GRID_SIZE, 0));
-    initializeGrid(grid);
-
-    // Create the "Score:" text texture
-    SDL_Color textColor = { 0, 0, 0, 255 }; // Black color for text
-    int score = 0;
-    SDL_Texture* scoreLabelTexture = renderText(renderer, font, "Score", textColor);
-    SDL_Texture* scoreValueTexture = renderText(renderer, font, "0", textColor);
-
+    // The start image and the tile images decode on every core while the start
+    // screen is up; only texture uploads run on this thread. The start image goes
+    // first, so it replaces the blank first frame as soon as possible.
+    std::vector<std::string> imageNames;
+    imageNames.push_back("Startimage.png");
+    for (int exponent = 1; exponent <= ATLAS_TILE_EXPONENTS; ++exponent) {
+        imageNames.push_back(tileImageName(exponent)); // At index exponent
+    }
+    TileAtlas tileAtlas;
+    GlyphAtlas glyphAtlas;
     bool quit = false;
-    SDL_Event e;
+    {
+        std::unique_ptr<ImageCache> imageCache;
+        char* prefPath = useImageCache ? SDL_GetPrefPath("BroochTR", "2048") : nullptr;
+        if (prefPath) {
+            imageCache.reset(new ImageCache(std::string(prefPath) + IMAGE_CACHE_NAME));
+            SDL_free(prefPath);
+        }
+        ImageLoader imageLoader(assets, imageNames, (int)std::thread::hardware_concurrency(), imageCache.get());
 
-    while (!quit) {
-        while (SDL_PollEvent(&e) != 0) {
-            if (e.type == SDL_QUIT) {
-                quit = true;
+        SDL_Texture* startTexture = nullptr;
+        bool startImageTaken = false;
+        renderStartScreen(renderer, startTexture);
+        SDL_RenderPresent(renderer);
+        double firstFrameMs = millisecondsSince(startCounter);
+
+        // All text is drawn from one glyph atlas, so a new score costs no rasterising or upload.
+        // FreeType runs here while the workers decode PNGs.
+        bool glyphsLoaded = loadGlyphAtlas(renderer, font, glyphAtlas);
+
+        SDL_Event e;
+        while (!imageLoader.done()) {
+            bool redrawStart = false;
+            if (!startImageTaken && imageLoader.ready(0)) {
+                SDL_Surface* startImage = imageLoader.take(0);
+                startTexture = startImage ? SDL_CreateTextureFromSurface(renderer, startImage) : nullptr;
+                SDL_FreeSurface(startImage);
+                startImageTaken = true;
+                redrawStart = true;
             }
-            else if (e.type == SDL_KEYDOWN) {
-                bool movedOrMerged = false;
-                switch (e.key.keysym.sym) {
-                case SDLK_UP:
-                    movedOrMerged = moveAndMergeTiles(grid, 0, score);
-                    break;
-                case SDLK_DOWN:
-                    movedOrMerged = moveAndMergeTiles(grid, 1, score);
-                    break;
-                case SDLK_LEFT:
-                    movedOrMerged = moveAndMergeTiles(grid, 2, score);
-                    break;
-                case SDLK_RIGHT:
-                    movedOrMerged = moveAndMergeTiles(grid, 3, score);
-                    break;
-                }
-                if (movedOrMerged) {
-                    spawnTile(grid);
-                    // Update score text texture
-                    SDL_DestroyTexture(scoreValueTexture);
-                    scoreValueTexture = renderText(renderer, font, std::to_string(score), textColor);
-                }
+            if (SDL_WaitEventTimeout(&e, LOADING_WAIT_MS)) {
+                if (e.type == SDL_QUIT) quit = true;
+                else if (e.type == SDL_WINDOWEVENT) redrawStart = true;
+            }
+            if (redrawStart) {
+                renderStartScreen(renderer, startTexture);
+                SDL_RenderPresent(renderer);
             }
         }
+        SDL_DestroyTexture(startTexture);
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_RenderClear(renderer);
-
-        // Render the extra area on the right side
-        SDL_Rect extraArea = { GRID_SIZE * TILE_SIZE, 0, EXTRA_WIDTH, WINDOW_HEIGHT };
-        SDL_SetRenderDrawColor(renderer, 253, 222, 179, 255); // #fddeb3
-        SDL_RenderFillRect(renderer, &extraArea);
-
-        // Render the border around the extra area
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // White color for the border
-        SDL_Rect extraAreaBorder = { GRID_SIZE * TILE_SIZE - BORDER_THICKNESS, -BORDER_THICKNESS, EXTRA_WIDTH + BORDER_THICKNESS, WINDOW_HEIGHT + BORDER_THICKNESS };
-        SDL_RenderDrawRect(renderer, &extraAreaBorder);
-
-        // Render the "Score:" label
-        int labelWidth, labelHeight;
-        SDL_QueryTexture(scoreLabelTexture, nullptr, nullptr, &labelWidth, &labelHeight);
-        SDL_Rect scoreLabelRect = { GRID_SIZE * TILE_SIZE + (EXTRA_WIDTH - labelWidth) / 2, 100, labelWidth, labelHeight };
-        SDL_RenderCopy(renderer, scoreLabelTexture, nullptr, &scoreLabelRect);
-
-        // Render the score value
-        int valueWidth, valueHeight;
-        SDL_QueryTexture(scoreValueTexture, nullptr, nullptr, &valueWidth, &valueHeight);
-        SDL_Rect scoreValueRect = { GRID_SIZE * TILE_SIZE + (EXTRA_WIDTH - valueWidth) / 2, 100 + labelHeight + 10, valueWidth, valueHeight }; // Positioned below the label
-        SDL_RenderCopy(renderer, scoreValueTexture, nullptr, &scoreValueRect);
-
-        // Render the grid
-        renderGrid(renderer, grid, tileTextures);
-
-        // Render the border around the grid
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // White color for the border
-        SDL_Rect gridRect = { 0, 0, GRID_SIZE * TILE_SIZE, GRID_SIZE * TILE_SIZE };
-        SDL_RenderDrawRect(renderer, &gridRect);
-
-        SDL_RenderPresent(renderer);
-
-        if (isGameOver(grid)) {
-            std::cout << "Game Over!" << std::endl;
-            quit = true;
+        SDL_Surface* tileImages[ATLAS_TILE_EXPONENTS + 1] = {};
+        for (int exponent = 1; exponent <= ATLAS_TILE_EXPONENTS; ++exponent) {
+            tileImages[exponent] = imageLoader.take(exponent);
+        }
+        bool built = buildTileAtlas(renderer, tileImages, tileAtlas);
+        for (SDL_Surface* image : tileImages) {
+            SDL_FreeSurface(image);
+        }
+        if (!built || !glyphsLoaded) {
+            destroyTileAtlas(tileAtlas);
+            destroyGlyphAtlas(glyphAtlas);
+            shutDown(font, renderer, window);
+            return -1;
         }
+        std::cout << "startup: first frame " << firstFrameMs << " ms, interactive " << millisecondsSince(startCounter) << " ms, images "
+            << imageLoader.seconds() * 1000 << " ms (" << imageLoader.cacheHits() << "/" << imageNames.size() << " from cache)" << std::endl;
     }
-
-    for (auto& pair : tileTextures) {
-        SDL_DestroyTexture(pair.second);
+    Board board;
+    bool recording = recordPath != nullptr;
+    bool playingBack = playbackPath != nullptr;
+    uint64_t replayPosition = 0; // Moves of the replay played so far
+    if (playingBack) {
+        initializeGame(board, replay.seed(), replay.stream());
     }
-
-    SDL_DestroyTexture(scoreLabelTexture);
-    SDL_DestroyTexture(scoreValueTexture);
-    TTF_CloseFont(font);
-
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    IMG_Quit();
-    TTF_Quit();
-    SDL_Quit();
-
-    return 0;
-}
-
-SDL_Texture* loadTexture(const std::string& path, SDL_Renderer* renderer) {
-    SDL_Texture* texture = IMG_LoadTexture(renderer, path.c_str());
-    if (!texture) {
-        std::cerr << "Failed to load texture: " << IMG_GetError() << std::endl;
+    else {
+        uint64_t seed = (uint64_t)std::time(nullptr);
+        initializeGame(board, seed);
+        if (recording) replay.start(seed, 0);
     }
-    return texture;
-}
-
-std::unordered_map<int, SDL_Texture*> loadTileTextures(SDL_Renderer* renderer) {
-    std::unordered_map<int, SDL_Texture*> textures;
-    textures[2] = loadTexture("E:/Test Project/images/2.png", renderer);
-    textures[4] = loadTexture("E:/Test Project/images/4.png", renderer);
-    textures[8] = loadTexture("E:/Test Project/images/8.png", renderer);
-    textures[16] = loadTexture("E:/Test Project/images/16.png", renderer);
-    textures[32] = loadTexture("E:/Test Project/images/32.png", renderer);
-    textures[64] = loadTexture("E:/Test Project/images/64.png", renderer);
-    textures[128] = loadTexture("E:/Test Project/images/128.png", renderer);
-    textures[256] = loadTexture("E:/Test Project/images/256.png", renderer);
-    textures[512] = loadTexture("E:/Test Project/images/512.png", renderer);
-    textures[1024] = loadTexture("E:/Test Project/images/1024.png", renderer);
-    textures[2048] = loadTexture("E:/Test Project/images/2048.png", renderer);
-    return textures;
-}
 
-SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
-    if (!surface) {
-        std::cerr << "Failed to create text surface: " << TTF_GetError() << std::endl;
-        return nullptr;
-    }
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
-    if (!texture) {
-        std::cerr << "Failed to create text texture: " << SDL_GetError() << std::endl;
-    }
-    return texture;
-}
+    int score = 0;
 
-void initializeGrid(std::vector<std::vector<int>>& grid) {
-    std::srand(std::time(nullptr));
-    spawnTile(grid);
-    spawnTile(grid);
-}
+    // Hint labels, indexed by direction like moveBoard
+    const char* hintLabels[4] = { "Hint: Up", "Hint: Down", "Hint: Left", "Hint: Right" };
+
+    // Press H to toggle hints. The engine searches on every core but one, leaving
+    // this thread free to keep drawing frames. Each new hint is pushed as an event,
+    // which wakes the loop below without it having to poll the engine.
+    int hintThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    Uint32 hintEvent = SDL_RegisterEvents(1);
+    HintEngine hintEngine(hintThreads, HINT_DEPTH, [hintEvent] {
+        SDL_Event event = {};
+        event.type = hintEvent;
+        SDL_PushEvent(&event);
+    });
+    bool showHint = false;
+
+    // Press A to toggle autoplay
+    SearchOptions autoplayOptions;
+    autoplayOptions.maxDepth = AUTOPLAY_DEPTH;
+    setPolicySearchOptions(autoplayOptions);
+    Autoplay autoplay(expectimaxPolicy);
+    Uint32 titleTicks = SDL_GetTicks();
+    uint64_t titleMoves = 0;
+
+    // Arrow keys go through a queue; a queued move cuts the running slide short
+    // instead of waiting for it, so key presses never lag behind the animation
+    InputQueue inputs;
+    SlideAnimation slide;
+    TileMove tileMoves[CELL_COUNT];
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+
+    // Press F3 for the profiler overlay (debug builds)
+    bool showProfiler = false;
+
+    BackgroundLayer background;
+    bool redraw = true; // Set whenever the board, score, hint or window contents change
+    int shownHint = -1;
+    FrameStats frameStats(SDL_GetTicks());
+    SDL_Event e;
 
-void renderGrid(SDL_Renderer* renderer, const std::vector<std::vector<int>>& grid, std::unordered_map<int, SDL_Texture*>& tileTextures) {
-    for (int i = 0; i < GRID_SIZE; ++i) {
-        for (int j = 0; j < GRID_SIZE; ++j) {
-            int value = grid[i][j];
-            SDL_Rect tileRect = { j * TILE_SIZE + TILE_PADDING, i * TILE_SIZE + TILE_PADDING, TILE_SIZE - TILE_PADDING * 2, TILE_SIZE - TILE_PADDING * 2 };
+    while (!quit) {
+        // Without pending changes, sleep in the event queue instead of redrawing;
+        // input, window changes and new hints all arrive there as events.
+        // While autoplay is moving the board, vsync in SDL_RenderPresent paces the loop.
+        bool haveEvent;
+        if (redraw) {
+            haveEvent = SDL_PollEvent(&e) != 0;
+        }
+        else if (autoplay.running()) {
+            haveEvent = SDL_WaitEventTimeout(&e, AUTOPLAY_WAIT_MS) != 0;
+        }
+        else {
+            haveEvent = SDL_WaitEvent(&e) != 0;
+        }
+        frameStats.loopWoke();
+        PROFILE_FRAME_BEGIN();
+
+        {
+            PROFILE_SCOPE(PHASE_EVENTS);
+            while (haveEvent) {
+                if (e.type == SDL_QUIT) {
+                    quit = true;
+                }
+                else if (e.type == SDL_WINDOWEVENT) {
+                    if (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) background.invalidate();
+                    redraw = true;
+                }
+                else if (e.type == SDL_RENDER_TARGETS_RESET) {
+                    restoreTileAtlas(renderer, tileAtlas);
+                    background.invalidate();
+                    redraw = true;
+                }
+#ifndef NDEBUG
+                else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3) {
+                    showProfiler = !showProfiler;
+                    redraw = true;
+                }
+#endif
+                else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_a && !playbackPath) {
+                    if (autoplay.running()) {
+                        // Take over from the board autoplay published as it stopped
+                        autoplay.stop();
+                        if (autoplay.poll()) {
+                            board = autoplay.snapshot().board;
+                            score = autoplay.snapshot().score;
+                        }
+                        SDL_SetWindowTitle(window, "2048 Game");
+                        if (showHint) hintEngine.setBoard(board);
+                    }
+                    else {
+                        // Autoplay draws from its own streams, so the replay ends here
+                        if (recording) std::cout << "recording stopped after " << replay.moveCount() << " moves: autoplay took over" << std::endl;
+                        recording = false;
+                        inputs.clear();
+                        slide.finish();
+                        autoplay.start(board, score, SDL_GetPerformanceCounter());
+                        titleTicks = SDL_GetTicks();
+                        titleMoves = 0;
+                    }
+                    redraw = true;
+                }
+                else if (e.type == SDL_KEYDOWN && !autoplay.running() && !playbackPath) {
+                    switch (e.key.keysym.sym) {
+                    case SDLK_UP:
+                        inputs.push(MOVE_UP);
+                        break;
+                    case SDLK_DOWN:
+                        inputs.push(MOVE_DOWN);
+                        break;
+                    case SDLK_LEFT:
+                        inputs.push(MOVE_LEFT);
+                        break;
+                    case SDLK_RIGHT:
+                        inputs.push(MOVE_RIGHT);
+                        break;
+                    case SDLK_h:
+                        showHint = !showHint;
+                        if (showHint) hintEngine.setBoard(board);
+                        redraw = true;
+                        break;
+                    }
+                }
+                haveEvent = SDL_PollEvent(&e) != 0;
+            }
+        }
 
-            // Draw tile background
-            if (value != 0) {
-                SDL_Texture* texture = tileTextures[value];
-                SDL_RenderCopy(renderer, texture, nullptr, &tileRect);
+        // Step the slide on its fixed timestep; every frame of a slide is drawn,
+        // plus one more for the final board
+        Uint64 counter = SDL_GetPerformanceCounter();
+        bool sliding = slide.active();
+        slide.advance((double)(counter - lastCounter) / SDL_GetPerformanceFrequency());
+        lastCounter = counter;
+        if (sliding) redraw = true;
+
+        // Playback feeds the replay through the same queue as the arrow keys, one move per slide
+        if (playingBack && inputs.empty() && !slide.active()) {
+            if (replayPosition < replay.moveCount()) {
+                inputs.push(replay.move(replayPosition++));
             }
             else {
-                SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255); // Background color for empty tiles
-                SDL_RenderFillRect(renderer, &tileRect);
+                std::cout << "replay finished: " << replayPosition << " moves, score " << score << std::endl;
+                SDL_SetWindowTitle(window, "2048 Game - replay finished");
+                playingBack = false;
             }
-
-            // Draw inner border around each tile
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // White color for the border
-            SDL_Rect innerBorderRect = { j * TILE_SIZE, i * TILE_SIZE, TILE_SIZE, TILE_SIZE };
-            SDL_RenderDrawRect(renderer, &innerBorderRect);
         }
-    }
-}
 
-void spawnTile(std::vector<std::vector<int>>& grid) {
-    // Function to get a random tile value from 2 to 512 (powers of 2)
-    auto getRandomTileValue = []() -> int {
-        int values[] = { 2, 4, 8, 16, 32 };
-        return values[std::rand() % (sizeof(values) / sizeof(values[0]))];
-    };
-
-    // Place the tile with the number 2
-    int x, y;
-    do {
-        x = std::rand() % GRID_SIZE;
-        y = std::rand() % GRID_SIZE;
-    } while (grid[x][y] != 0);
-
-    grid[x][y] = 2;
-
-    // Place the extra random tile
-    int extraX, extraY;
-    do {
-        extraX = std::rand() % GRID_SIZE;
-        extraY = std::rand() % GRID_SIZE;
-    } while (grid[extraX][extraY] != 0);
-
-    grid[extraX][extraY] = getRandomTileValue();
-}
-
-bool moveAndMergeTiles(std::vector<std::vector<int>>& grid, int direction, int& score) {
-    bool moved = false;
-    bool merged = false;
-
-    auto slideAndMerge = [&](std::vector<int>& line) -> int {
-        std::vector<int> newLine(GRID_SIZE, 0);
-        int lastIndex = -1;
-        int lineScore = 0;
-
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            if (line[i] != 0) {
-                int value = line[i];
-                if (lastIndex != -1 && newLine[lastIndex] == value) {
-                    newLine[lastIndex] *= 2;
-                    line[i] = 0;
-                    lineScore += newLine[lastIndex]; // Update score with the merged value
-                    merged = true;
-                }
-                else {
-                    lastIndex = (lastIndex + 1);
-                    newLine[lastIndex] = value;
+        // Play the oldest queued move; the board and score change at once, the slide just shows it
+        int direction;
+        if (!inputs.empty() && slide.active()) slide.finish();
+        if (!slide.active() && inputs.pop(direction)) {
+            // Like the render path below, a move and its spawn never touch the heap
+            uint64_t allocationsBefore = threadAllocationCount();
+            int moveCount = 0;
+            bool moved;
+            {
+                PROFILE_SCOPE(PHASE_MOVE);
+                moved = slideBoard(board, direction, score, tileMoves, moveCount);
+            }
+            if (moved) {
+                {
+                    PROFILE_SCOPE(PHASE_SPAWN);
+                    spawnAfterSlide(board);
                 }
+                slide.start(tileMoves, moveCount);
+            }
+            assert(threadAllocationCount() == allocationsBefore && "move path allocated");
+            (void)allocationsBefore;
+            if (moved) {
+                if (showHint) hintEngine.setBoard(board);
+                redraw = true;
+            }
+            // Recording stays off the heap for the first REPLAY_RESERVE_MOVES moves
+            if (moved && recording) replay.record(direction, board, score);
+            if (playingBack && (!moved || !replay.matches(replayPosition, board, score))) {
+                std::cerr << "replay diverged at move " << replayPosition << (moved ? ": board checksum mismatch" : ": move does not change the board") << std::endl;
+                SDL_SetWindowTitle(window, "2048 Game - replay diverged");
+                playingBack = false;
+                inputs.clear();
             }
         }
 
-        if (newLine != line) {
-            moved = true;
-        }
-        line = newLine;
-        return lineScore;
-    };
-
-    auto processGrid = [&](bool reverse) {
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            std::vector<int> line(GRID_SIZE);
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                if (direction == 0) line[j] = grid[j][i];        // Up
-                if (direction == 1) line[j] = grid[GRID_SIZE - 1 - j][i]; // Down
-                if (direction == 2) line[j] = grid[i][j];        // Left
-                if (direction == 3) line[j] = grid[i][GRID_SIZE - 1 - j]; // Right
+        // Show only the newest autoplay board; moves played in between are never drawn
+        if (autoplay.running() && autoplay.poll()) {
+            const AutoplaySnapshot& snapshot = autoplay.snapshot();
+            board = snapshot.board;
+            score = snapshot.score;
+            redraw = true;
+
+            Uint32 now = SDL_GetTicks();
+            if (now - titleTicks >= 1000) {
+                std::string title = "2048 Game - autoplay " + std::to_string((snapshot.moves - titleMoves) * 1000 / (now - titleTicks)) +
+                    " moves/s, " + std::to_string(snapshot.games) + " games";
+                SDL_SetWindowTitle(window, title.c_str());
+                titleTicks = now;
+                titleMoves = snapshot.moves;
             }
+        }
+
+        // The hint engine finishing another depth (hintEvent) can change the hint on screen
+        int hintMove = showHint && !autoplay.running() ? hintEngine.bestMove() : -1;
+        if (hintMove != shownHint) {
+            shownHint = hintMove;
+            redraw = true;
+        }
 
-            int lineScore = slideAndMerge(line);
+        if (redraw) {
+            // Nothing between here and the present may touch the heap
+            uint64_t allocationsBefore = threadAllocationCount();
 
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                if (direction == 0) grid[j][i] = line[j];        // Up
-                if (direction == 1) grid[GRID_SIZE - 1 - j][i] = line[j]; // Down
-                if (direction == 2) grid[i][j] = line[j];        // Left
-                if (direction == 3) grid[i][GRID_SIZE - 1 - j] = line[j]; // Right
+            {
+                // Side panel with the score and the latest hint, if the engine has
+                // finished at least one depth
+                PROFILE_SCOPE(PHASE_PANEL);
+                renderPanel(renderer, background, glyphAtlas, score, shownHint >= 0 ? hintLabels[shownHint] : nullptr);
             }
 
-            score += lineScore;
+            // Render the grid in one batch
+            {
+                PROFILE_SCOPE(PHASE_GRID);
+                if (slide.active()) renderSlide(renderer, slide, tileAtlas, glyphAtlas);
+                else renderGrid(renderer, board, tileAtlas, glyphAtlas);
+            }
+            // Shows the frames before this one, so its own cost is not in the numbers
+            if (showProfiler) renderProfilerOverlay(renderer, mainProfiler(), tileAtlas, glyphAtlas);
+            assert(threadAllocationCount() == allocationsBefore && "render path allocated");
+            (void)allocationsBefore;
+
+            {
+                PROFILE_SCOPE(PHASE_PRESENT);
+                SDL_RenderPresent(renderer);
+            }
+            PROFILE_FRAME_END();
+            frameStats.frameRendered();
+            redraw = false;
         }
-    };
-
-    processGrid(direction == 1 || direction == 3);
-    return moved || merged;
-}
 
-bool isGameOver(const std::vector<std::vector<int>>& grid) {
-    for (int i = 0; i < GRID_SIZE; ++i) {
-        for (int j = 0; j < GRID_SIZE; ++j) {
-            if (grid[i][j] == 0) return false;
-            if (i < GRID_SIZE - 1 && grid[i][j] == grid[i + 1][j]) return false;
-            if (j < GRID_SIZE - 1 && grid[i][j] == grid[i][j + 1]) return false;
+        // A finished replay stays on screen until the window is closed
+        if (!playbackPath && !autoplay.running() && !slide.active() && inputs.empty() && isBoardGameOver(board)) {
+            std::cout << "Game Over!" << std::endl;
+            quit = true;
         }
+        if (printFrameStats) frameStats.update(SDL_GetTicks());
+    }
+    frameStats.printTotals(SDL_GetTicks());
+    hintEngine.stop(); // Its worker pushes events, so it has to finish before SDL_Quit
+    if (recordPath) {
+        if (replay.save(recordPath)) std::cout << "replay saved to " << recordPath << ": " << replay.moveCount() << " moves" << std::endl;
+        else std::cerr << "Failed to save replay " << recordPath << std::endl;
+    }
+    if (tracePath) {
+        if (mainProfiler().writeTrace(tracePath)) std::cout << "trace written to " << tracePath << std::endl;
+        else std::cerr << "Failed to write trace " << tracePath << std::endl;
     }
-    return true;
-}
 
+    background.release();
+    destroyTileAtlas(tileAtlas);
+    destroyGlyphAtlas(glyphAtlas);
+    shutDown(font, renderer, window);
+
+    return 0;
+}
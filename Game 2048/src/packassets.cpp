@@ -0,0 +1,106 @@
+// Build step: packs the game's images and font into one archive that the game
+// memory-maps at startup (see assetpack.h). Directories are packed file by file,
+// without recursing, e.g.
+//   g++ -O2 -std=c++17 packassets.cpp -o packassets
+//   ./packassets assets.pak "../Resource Files" ../../2048-font.ttf
+// Copy assets.pak next to the game executable.
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "assetpack.h"
+
+namespace fs = std::filesystem;
+
+struct PackFile {
+    std::string name;
+    std::vector<char> bytes;
+};
+
+static bool readFile(const fs::path& path, std::vector<PackFile>& files) {
+    std::string name = path.filename().string();
+    if (name.size() >= (size_t)PACK_NAME_BYTES) {
+        std::fprintf(stderr, "name too long for the archive index: %s\n", name.c_str());
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "cannot read %s\n", path.string().c_str());
+        return false;
+    }
+    PackFile file;
+    file.name = name;
+    file.bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    files.push_back(std::move(file));
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::printf("usage: packassets OUTPUT FILE_OR_DIRECTORY...\n");
+        return 1;
+    }
+
+    std::vector<PackFile> files;
+    for (int i = 2; i < argc; ++i) {
+        fs::path path = argv[i];
+        std::error_code error;
+        if (fs::is_directory(path, error)) {
+            for (const fs::directory_entry& entry : fs::directory_iterator(path)) {
+                if (entry.is_regular_file() && !readFile(entry.path(), files)) return 1;
+            }
+        }
+        else if (!readFile(path, files)) {
+            return 1;
+        }
+    }
+
+    // The game looks names up by binary search
+    std::sort(files.begin(), files.end(), [](const PackFile& a, const PackFile& b) {
+        return std::strncmp(a.name.c_str(), b.name.c_str(), PACK_NAME_BYTES) < 0;
+    });
+    for (size_t i = 1; i < files.size(); ++i) {
+        if (files[i].name == files[i - 1].name) {
+            std::fprintf(stderr, "two files named %s\n", files[i].name.c_str());
+            return 1;
+        }
+    }
+
+    PackHeader header = {};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.count = (uint32_t)files.size();
+
+    std::vector<PackEntry> entries(files.size());
+    uint64_t offset = sizeof(PackHeader) + files.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < files.size(); ++i) {
+        offset = (offset + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+        std::memset(&entries[i], 0, sizeof(PackEntry));
+        std::memcpy(entries[i].name, files[i].name.c_str(), files[i].name.size());
+        entries[i].offset = offset;
+        entries[i].size = files[i].bytes.size();
+        offset += files[i].bytes.size();
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+    uint64_t written = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    const char padding[PACK_ALIGN] = {};
+    for (size_t i = 0; i < files.size(); ++i) {
+        out.write(padding, (std::streamsize)(entries[i].offset - written));
+        out.write(files[i].bytes.data(), (std::streamsize)files[i].bytes.size());
+        written = entries[i].offset + files[i].bytes.size();
+    }
+    // close() flushes the last buffered bytes, so a full disk may only show up here
+    out.close();
+    if (!out.good()) {
+        std::fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("packed %d files, %llu bytes, into %s\n", (int)files.size(), (unsigned long long)written, argv[1]);
+    return 0;
+}
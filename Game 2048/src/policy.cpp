@@ -0,0 +1,94 @@
+#include "policy.h"
+#include <atomic>
+#include <memory>
+
+static SearchOptions policyOptions;
+static std::unique_ptr<ParallelSearch> policyParallelSearch;
+static std::atomic<uint64_t> totalNodes(0);
+static std::atomic<uint64_t> totalTableHits(0);
+static std::atomic<uint64_t> totalDepth(0);
+static std::atomic<uint64_t> totalSearches(0);
+static std::atomic<uint64_t> totalMicroseconds(0);
+
+int randomPolicy(const Board& board, Rng& rng) {
+    int legal[4];
+    int count = 0;
+    for (int direction = 0; direction < 4; ++direction) {
+        Board next = board;
+        int score = 0;
+        if (moveBoard(next, direction, score)) legal[count++] = direction;
+    }
+    if (count == 0) return -1;
+    return legal[rng.below(count)];
+}
+
+int greedyPolicy(const Board& board, Rng&) {
+    // Highest merge score first, then the move that leaves the most empty cells
+    int best = -1;
+    int bestScore = -1;
+    int bestEmpty = -1;
+    for (int direction = 0; direction < 4; ++direction) {
+        Board next = board;
+        int score = 0;
+        if (!moveBoard(next, direction, score)) continue;
+        int empty = countEmptyCells(next);
+        if (score > bestScore || (score == bestScore && empty > bestEmpty)) {
+            best = direction;
+            bestScore = score;
+            bestEmpty = empty;
+        }
+    }
+    return best;
+}
+
+int cornerPolicy(const Board& board, Rng&) {
+    // Keep the big tiles in the bottom-left corner: down, left, right, then up
+    const int order[4] = { MOVE_DOWN, MOVE_LEFT, MOVE_RIGHT, MOVE_UP };
+    for (int direction : order) {
+        Board next = board;
+        int score = 0;
+        if (moveBoard(next, direction, score)) return direction;
+    }
+    return -1;
+}
+
+int expectimaxPolicy(const Board& board, Rng&) {
+    // One engine per thread keeps its transposition table between moves
+    thread_local SearchEngine engine;
+    SearchResult result = policyParallelSearch
+        ? searchBestMoveParallel(*policyParallelSearch, board, policyOptions)
+        : searchBestMove(engine, board, policyOptions);
+    totalNodes += result.stats.nodes;
+    totalTableHits += result.stats.tableHits;
+    totalDepth += (uint64_t)result.stats.depthReached;
+    totalSearches += 1;
+    totalMicroseconds += (uint64_t)(result.stats.seconds * 1e6);
+    return result.move;
+}
+
+void setPolicySearchOptions(const SearchOptions& options, int searchThreads) {
+    policyOptions = options;
+    policyParallelSearch.reset(searchThreads > 1 ? new ParallelSearch(searchThreads) : nullptr);
+}
+
+SearchStats policySearchStats() {
+    SearchStats stats;
+    stats.nodes = totalNodes;
+    stats.tableHits = totalTableHits;
+    uint64_t searches = totalSearches;
+    stats.depthReached = searches ? (int)(totalDepth / searches) : 0;
+    stats.seconds = totalMicroseconds * 1e-6;
+    return stats;
+}
+
+MovePolicy findPolicy(const std::string& name) {
+    if (name == "random") return randomPolicy;
+    if (name == "greedy") return greedyPolicy;
+    if (name == "corner") return cornerPolicy;
+    if (name == "expectimax") return expectimaxPolicy;
+    return nullptr;
+}
+
+const char* policyNames() {
+    return "random, greedy, corner, expectimax";
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include "ai.h"
+
+// A move policy picks the next direction for a board.
+// It returns -1 when no direction changes the board.
+typedef int (*MovePolicy)(const Board& board, Rng& rng);
+
+int randomPolicy(const Board& board, Rng& rng);
+int greedyPolicy(const Board& board, Rng& rng);
+int cornerPolicy(const Board& board, Rng& rng);
+int expectimaxPolicy(const Board& board, Rng& rng);
+
+// Options used by expectimaxPolicy on every thread; set before playing.
+// With searchThreads > 1 each move is searched by one shared ParallelSearch,
+// so games must then be played one at a time.
+void setPolicySearchOptions(const SearchOptions& options, int searchThreads = 1);
+// Search statistics summed over every expectimaxPolicy call so far
+SearchStats policySearchStats();
+
+// Looks a policy up by name ("random", "greedy", "corner", "expectimax"), nullptr if unknown
+MovePolicy findPolicy(const std::string& name);
+const char* policyNames();
@@ -0,0 +1,121 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+const char* profilePhaseName(int phase) {
+    static const char* const names[PHASE_COUNT + 1] = { "events", "move", "spawn", "panel", "grid", "present", "frame" };
+    return names[phase >= 0 && phase < PHASE_COUNT ? phase : PHASE_COUNT];
+}
+
+uint64_t Profiler::now() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::beginFrame() {
+    frameStart = now();
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        phaseNs[phase] = 0;
+        phaseRan[phase] = false;
+    }
+    frameEventCount = 0;
+}
+
+void Profiler::record(int phase, uint64_t start, uint64_t end) {
+    phaseNs[phase] += end - start;
+    phaseRan[phase] = true;
+    if (!trace) return;
+    if (frameEventCount == FRAME_EVENT_LIMIT) {
+        ++droppedEvents;
+        return;
+    }
+    TraceEvent event = { start - traceOrigin, end - start, phase };
+    frameEvents[frameEventCount++] = event;
+}
+
+void Profiler::endFrame() {
+    uint64_t end = now();
+    // Phases that ran several times in the frame, such as queued moves, count as one sample
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        if (!phaseRan[phase]) continue;
+        phaseHistory[phase][phaseNext[phase]] = (float)(phaseNs[phase] * 1e-6);
+        phaseNext[phase] = (phaseNext[phase] + 1) % PROFILE_HISTORY;
+        phaseSamples[phase] = std::min(phaseSamples[phase] + 1, PROFILE_HISTORY);
+    }
+    frameHistory[frameNext] = (float)((end - frameStart) * 1e-6);
+    frameNext = (frameNext + 1) % PROFILE_HISTORY;
+    frames = std::min(frames + 1, PROFILE_HISTORY);
+    if (trace) {
+        TraceEvent frame = { frameStart - traceOrigin, end - frameStart, PHASE_COUNT };
+        addTraceEvent(frame);
+        for (int i = 0; i < frameEventCount; ++i) {
+            addTraceEvent(frameEvents[i]);
+        }
+    }
+    beginFrame();
+}
+
+// Nearest-rank percentiles of the first samples entries of history
+static PhaseSummary summarize(const float* history, int samples) {
+    PhaseSummary result;
+    result.samples = samples;
+    if (samples == 0) return result;
+
+    float sorted[PROFILE_HISTORY];
+    std::copy(history, history + samples, sorted);
+    std::sort(sorted, sorted + samples);
+    result.p50Ms = sorted[(samples + 1) / 2 - 1];
+    result.p99Ms = sorted[(samples * 99 + 99) / 100 - 1];
+    return result;
+}
+
+PhaseSummary Profiler::summary(int phase) const {
+    return summarize(phaseHistory[phase], phaseSamples[phase]);
+}
+
+PhaseSummary Profiler::frameSummary() const {
+    return summarize(frameHistory, frames);
+}
+
+double Profiler::frameMs(int index) const {
+    int oldest = frames < PROFILE_HISTORY ? 0 : frameNext;
+    return frameHistory[(oldest + index) % PROFILE_HISTORY];
+}
+
+void Profiler::startTrace() {
+    traceEvents.clear();
+    traceEvents.reserve(TRACE_EVENT_LIMIT);
+    traceOrigin = now();
+    droppedEvents = 0;
+    trace = true;
+}
+
+void Profiler::addTraceEvent(const TraceEvent& event) {
+    if (traceEvents.size() == traceEvents.capacity()) {
+        ++droppedEvents;
+        return;
+    }
+    traceEvents.push_back(event);
+}
+
+bool Profiler::writeTrace(const char* path) const {
+    FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+
+    // Complete ("X") events with microsecond timestamps; frames and phases share
+    // one track, so each frame nests the phases it ran
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%llu},\"traceEvents\":[\n", (unsigned long long)droppedEvents);
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main loop\"}}");
+    for (const TraceEvent& event : traceEvents) {
+        std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+            profilePhaseName(event.phase), event.phase == PHASE_COUNT ? "frame" : "phase", event.start * 1e-3, event.duration * 1e-3);
+    }
+    std::fprintf(file, "\n]}\n");
+    bool written = std::ferror(file) == 0;
+    return std::fclose(file) == 0 && written;
+}
+
+Profiler& mainProfiler() {
+    static Profiler profiler;
+    return profiler;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Phases of one main-loop iteration
+enum ProfilePhase {
+    PHASE_EVENTS,  // Handling the events that woke the loop, not the wait itself
+    PHASE_MOVE,    // Sliding and merging the board
+    PHASE_SPAWN,
+    PHASE_PANEL,   // Cached background and the score and hint text
+    PHASE_GRID,    // Grid or slide animation
+    PHASE_PRESENT, // Includes the vsync wait
+    PHASE_COUNT
+};
+
+const int PROFILE_HISTORY = 240; // Frames kept for the percentiles and the graph
+const int TRACE_EVENT_LIMIT = 1 << 20; // Events after this many are dropped, about 24 MB
+const int FRAME_EVENT_LIMIT = 64; // Phase events one frame can hold until it is drawn
+
+const char* profilePhaseName(int phase);
+
+struct PhaseSummary {
+    double p50Ms = 0;
+    double p99Ms = 0;
+    int samples = 0; // Frames in the history that ran the phase
+};
+
+// Time spent in each phase over the last PROFILE_HISTORY drawn frames, and
+// optionally every phase of every frame for a Chrome trace_event file. Only the
+// main thread records. Storage is fixed once tracing starts, so recording never
+// allocates.
+class Profiler {
+public:
+    // Nanoseconds on a steady clock
+    static uint64_t now();
+
+    // A frame runs from the loop waking up to the present; phases recorded
+    // outside a drawn frame, such as a wake-up with nothing to draw, are
+    // discarded by the next beginFrame, trace events included
+    void beginFrame();
+    void endFrame();
+    void record(int phase, uint64_t start, uint64_t end);
+
+    PhaseSummary summary(int phase) const;
+    PhaseSummary frameSummary() const;
+    int frameCount() const { return frames; }
+    // Busy time of a frame in milliseconds, 0 the oldest kept
+    double frameMs(int index) const;
+
+    void startTrace();
+    bool tracing() const { return trace; }
+    // Writes the JSON object format Perfetto and chrome://tracing open
+    bool writeTrace(const char* path) const;
+
+private:
+    struct TraceEvent {
+        uint64_t start;
+        uint64_t duration;
+        int phase; // PHASE_COUNT for the whole frame
+    };
+
+    uint64_t frameStart = 0;
+    uint64_t phaseNs[PHASE_COUNT] = {};
+    bool phaseRan[PHASE_COUNT] = {};
+
+    float phaseHistory[PHASE_COUNT][PROFILE_HISTORY] = {};
+    int phaseSamples[PHASE_COUNT] = {};
+    int phaseNext[PHASE_COUNT] = {};
+    float frameHistory[PROFILE_HISTORY] = {};
+    int frames = 0;
+    int frameNext = 0;
+
+    bool trace = false;
+    uint64_t traceOrigin = 0;
+    uint64_t droppedEvents = 0;
+    std::vector<TraceEvent> traceEvents;
+    // This frame's phases, held back until endFrame shows it was drawn
+    TraceEvent frameEvents[FRAME_EVENT_LIMIT] = {};
+    int frameEventCount = 0;
+
+    void addTraceEvent(const TraceEvent& event);
+};
+
+// The profiler the main loop reports to
+Profiler& mainProfiler();
+
+// Records the enclosing scope as one phase of the current frame
+class ProfileScope {
+public:
+    explicit ProfileScope(int phase) : phase(phase), start(Profiler::now()) {}
+    ~ProfileScope() { mainProfiler().record(phase, start, Profiler::now()); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int phase;
+    uint64_t start;
+};
+
+// Timers exist in debug builds only; with NDEBUG they compile to nothing
+#ifndef NDEBUG
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(phase)
+#define PROFILE_FRAME_BEGIN() mainProfiler().beginFrame()
+#define PROFILE_FRAME_END() mainProfiler().endFrame()
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_FRAME_BEGIN() ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+#include <SDL.h>
+#include <cstdint>
+
+// Draw calls the render code has submitted to SDL so far, defined in render.cpp.
+// Read by the render benchmark; only the render thread touches it.
+extern uint64_t renderDrawCalls;
+
+// Up to Capacity textured quads from one texture, submitted with a single
+// SDL_RenderGeometry call. The arrays live inside the batch, so filling and
+// drawing one never allocates.
+template <int Capacity>
+class QuadBatch {
+public:
+    // textureWidth/Height convert src from texels to texture coordinates
+    QuadBatch(int textureWidth, int textureHeight) : textureWidth((float)textureWidth), textureHeight((float)textureHeight) {}
+
+    int size() const { return quads; }
+    void clear() { quads = 0; }
+
+    // Quads past Capacity are dropped
+    void add(const SDL_Rect& dst, const SDL_Rect& src, SDL_Color color) {
+        if (quads == Capacity) return;
+        float u0 = src.x / textureWidth;
+        float v0 = src.y / textureHeight;
+        float u1 = (src.x + src.w) / textureWidth;
+        float v1 = (src.y + src.h) / textureHeight;
+        float x0 = (float)dst.x;
+        float y0 = (float)dst.y;
+        float x1 = (float)(dst.x + dst.w);
+        float y1 = (float)(dst.y + dst.h);
+
+        int first = quads * 4;
+        SDL_Vertex* v = vertices + first;
+        v[0] = { { x0, y0 }, color, { u0, v0 } };
+        v[1] = { { x1, y0 }, color, { u1, v0 } };
+        v[2] = { { x1, y1 }, color, { u1, v1 } };
+        v[3] = { { x0, y1 }, color, { u0, v1 } };
+
+        int* index = indices + quads * 6;
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first;
+        index[4] = first + 2;
+        index[5] = first + 3;
+        ++quads;
+    }
+
+    void draw(SDL_Renderer* renderer, SDL_Texture* texture) const {
+        if (quads == 0) return;
+        SDL_RenderGeometry(renderer, texture, vertices, quads * 4, indices, quads * 6);
+        ++renderDrawCalls;
+    }
+
+private:
+    float textureWidth;
+    float textureHeight;
+    SDL_Vertex vertices[Capacity * 4];
+    int indices[Capacity * 6];
+    int quads = 0;
+};
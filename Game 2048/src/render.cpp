@@ -0,0 +1,394 @@
+#include "render.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "quadbatch.h"
+
+const int ATLAS_SLOT = 64;    // Tile images are 64x64; other sizes are scaled to fit
+const int ATLAS_GUTTER = 1;   // Gap between slots so filtering never bleeds into a neighbour
+const int ATLAS_COLUMNS = 4;
+const int FIRST_GENERATED_SLOT = ATLAS_TILE_EXPONENTS + 1;
+const int ATLAS_SLOTS = FIRST_GENERATED_SLOT + GENERATED_TILE_SLOTS;
+const int GENERATED_TEXT_MARGIN = 6; // Space left on either side of a generated tile's value
+
+const SDL_Color EMPTY_CELL_COLOR = { 200, 200, 200, 255 };
+const SDL_Color BORDER_COLOR = { 255, 255, 255, 255 };
+const SDL_Color PANEL_COLOR = { 253, 222, 179, 255 }; // #fddeb3
+const SDL_Color TILE_TINT = { 255, 255, 255, 255 }; // Leaves the tile image unchanged
+const SDL_Color GENERATED_TEXT_COLOR = { 255, 255, 255, 255 };
+const SDL_Color PANEL_TEXT_COLOR = { 0, 0, 0, 255 };
+const int SCORE_LABEL_Y = 100;
+
+uint64_t renderDrawCalls = 0;
+
+static SDL_Rect atlasSlotRect(int slot) {
+    SDL_Rect rect = {
+        ATLAS_GUTTER + (slot % ATLAS_COLUMNS) * (ATLAS_SLOT + 2 * ATLAS_GUTTER),
+        ATLAS_GUTTER + (slot / ATLAS_COLUMNS) * (ATLAS_SLOT + 2 * ATLAS_GUTTER),
+        ATLAS_SLOT,
+        ATLAS_SLOT
+    };
+    return rect;
+}
+
+std::string tileImageName(int exponent) {
+    return std::to_string(exponentToValue(exponent)) + ".png";
+}
+
+// Copies the sheet into the atlas texture and empties the generated slots
+static bool uploadSheet(SDL_Renderer* renderer, TileAtlas& atlas) {
+    SDL_Texture* images = SDL_CreateTextureFromSurface(renderer, atlas.sheet);
+    if (!images) {
+        std::cerr << "Failed to create atlas texture: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    if (!atlas.texture && SDL_RenderTargetSupported(renderer)) {
+        atlas.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, atlas.width, atlas.height);
+        if (atlas.texture) SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    }
+
+    if (atlas.texture) {
+        SDL_SetTextureBlendMode(images, SDL_BLENDMODE_NONE);
+        SDL_SetRenderTarget(renderer, atlas.texture);
+        SDL_RenderCopy(renderer, images, nullptr, nullptr);
+        SDL_SetRenderTarget(renderer, nullptr);
+        SDL_DestroyTexture(images);
+        atlas.canGenerate = true;
+    }
+    else {
+        // No render targets: keep the plain texture, tiles without an image fall back to flat colour
+        atlas.texture = images;
+        atlas.canGenerate = false;
+    }
+
+    for (int exponent = 0; exponent < TILE_EXPONENTS; ++exponent) {
+        if (atlas.tileSlot[exponent] >= 0) atlas.tiles[exponent] = SDL_Rect();
+        atlas.tileSlot[exponent] = -1;
+    }
+    for (int slot = 0; slot < GENERATED_TILE_SLOTS; ++slot) {
+        atlas.slotExponent[slot] = 0;
+        atlas.slotLastUsed[slot] = 0;
+    }
+    return true;
+}
+
+bool buildTileAtlas(SDL_Renderer* renderer, SDL_Surface* const images[ATLAS_TILE_EXPONENTS + 1], TileAtlas& atlas) {
+    int rows = (ATLAS_SLOTS + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    atlas.width = ATLAS_COLUMNS * (ATLAS_SLOT + 2 * ATLAS_GUTTER);
+    atlas.height = rows * (ATLAS_SLOT + 2 * ATLAS_GUTTER);
+    atlas.sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas.width, atlas.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas.sheet) {
+        std::cerr << "Failed to create atlas surface: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_Surface* sheet = atlas.sheet;
+    SDL_FillRect(sheet, nullptr, SDL_MapRGBA(sheet->format, 0, 0, 0, 0));
+
+    atlas.solid = atlasSlotRect(0);
+    SDL_FillRect(sheet, &atlas.solid, SDL_MapRGBA(sheet->format, 255, 255, 255, 255));
+
+    for (int exponent = 1; exponent <= ATLAS_TILE_EXPONENTS; ++exponent) {
+        SDL_Surface* image = images[exponent];
+        if (!image) continue;
+        // Copy the pixels including alpha instead of blending onto the empty sheet
+        SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+        SDL_Rect slot = atlasSlotRect(exponent);
+        if (SDL_BlitScaled(image, nullptr, sheet, &slot) == 0) {
+            atlas.tiles[exponent] = slot;
+        }
+    }
+    for (int exponent = 0; exponent < TILE_EXPONENTS; ++exponent) {
+        atlas.tileSlot[exponent] = -1;
+    }
+    return uploadSheet(renderer, atlas);
+}
+
+bool restoreTileAtlas(SDL_Renderer* renderer, TileAtlas& atlas) {
+    return atlas.sheet && uploadSheet(renderer, atlas);
+}
+
+void destroyTileAtlas(TileAtlas& atlas) {
+    SDL_DestroyTexture(atlas.texture);
+    SDL_FreeSurface(atlas.sheet);
+    atlas.texture = nullptr;
+    atlas.sheet = nullptr;
+}
+
+// Background of a generated tile: each doubling turns the hue a little further
+static SDL_Color generatedTileColor(int exponent) {
+    float hue = (float)((exponent * 47) % 360) / 60.0f;
+    float value = 0.78f;
+    float chroma = value * 0.65f;
+    float x = chroma * (1.0f - std::abs(std::fmod(hue, 2.0f) - 1.0f));
+    float r = 0, g = 0, b = 0;
+    switch ((int)hue) {
+    case 0: r = chroma; g = x; break;
+    case 1: r = x; g = chroma; break;
+    case 2: g = chroma; b = x; break;
+    case 3: g = x; b = chroma; break;
+    case 4: r = x; b = chroma; break;
+    default: r = chroma; b = x; break;
+    }
+    float m = value - chroma;
+    SDL_Color color = { (Uint8)((r + m) * 255), (Uint8)((g + m) * 255), (Uint8)((b + m) * 255), 255 };
+    return color;
+}
+
+static void drawGeneratedTile(SDL_Renderer* renderer, TileAtlas& atlas, const GlyphAtlas& glyphs, const SDL_Rect& rect, int exponent) {
+    // Callers keep their own target and blend mode
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_BlendMode previousBlend = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode(renderer, &previousBlend);
+    SDL_SetRenderTarget(renderer, atlas.texture);
+    SDL_Color color = generatedTileColor(exponent);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+    SDL_RenderFillRect(renderer, &rect);
+    ++renderDrawCalls;
+
+    // The value, shrunk to fit when it has many digits
+    char digits[21]; // Any unsigned long long
+    std::snprintf(digits, sizeof(digits), "%llu", 1ull << exponent);
+    int width = textWidth(glyphs, digits);
+    float scale = std::min(1.0f, (float)(rect.w - 2 * GENERATED_TEXT_MARGIN) / std::max(width, 1));
+    TextBatch text(glyphs.width, glyphs.height);
+    int x = rect.x + (rect.w - (int)(width * scale)) / 2;
+    int y = rect.y + (rect.h - (int)(glyphs.lineHeight * scale)) / 2;
+    addText(text, glyphs, digits, x, y, GENERATED_TEXT_COLOR, scale);
+    text.draw(renderer, glyphs.texture);
+    SDL_SetRenderDrawBlendMode(renderer, previousBlend);
+    SDL_SetRenderTarget(renderer, previousTarget);
+}
+
+// Source rect for a tile, drawing it into a generated slot first if needed.
+// w == 0 if there is no room: every slot already holds a tile of this frame.
+static SDL_Rect tileSource(SDL_Renderer* renderer, TileAtlas& atlas, const GlyphAtlas& glyphs, int exponent) {
+    int slot = atlas.tileSlot[exponent];
+    if (slot >= 0) {
+        atlas.slotLastUsed[slot] = atlas.frame;
+        return atlas.tiles[exponent];
+    }
+    if (atlas.tiles[exponent].w > 0 || !atlas.canGenerate) return atlas.tiles[exponent];
+
+    slot = 0;
+    for (int i = 1; i < GENERATED_TILE_SLOTS; ++i) {
+        if (atlas.slotLastUsed[i] < atlas.slotLastUsed[slot]) slot = i;
+    }
+    if (atlas.slotExponent[slot] != 0 && atlas.slotLastUsed[slot] == atlas.frame) return SDL_Rect();
+
+    int evicted = atlas.slotExponent[slot];
+    if (evicted != 0) {
+        atlas.tiles[evicted] = SDL_Rect();
+        atlas.tileSlot[evicted] = -1;
+    }
+    SDL_Rect rect = atlasSlotRect(FIRST_GENERATED_SLOT + slot);
+    drawGeneratedTile(renderer, atlas, glyphs, rect, exponent);
+    atlas.tiles[exponent] = rect;
+    atlas.tileSlot[exponent] = slot;
+    atlas.slotExponent[slot] = exponent;
+    atlas.slotLastUsed[slot] = atlas.frame;
+    return rect;
+}
+
+void renderStartScreen(SDL_Renderer* renderer, SDL_Texture* image) {
+    SDL_SetRenderDrawColor(renderer, PANEL_COLOR.r, PANEL_COLOR.g, PANEL_COLOR.b, PANEL_COLOR.a);
+    SDL_RenderClear(renderer);
+    if (!image) return;
+    // Square image, as large as the window height allows, centred
+    SDL_Rect imageRect = { (WINDOW_WIDTH - WINDOW_HEIGHT) / 2, 0, WINDOW_HEIGHT, WINDOW_HEIGHT };
+    SDL_RenderCopy(renderer, image, nullptr, &imageRect);
+}
+
+static SDL_Rect cellTileRect(int cell) {
+    SDL_Rect rect = { (cell % GRID_SIZE) * TILE_SIZE + TILE_PADDING, (cell / GRID_SIZE) * TILE_SIZE + TILE_PADDING, TILE_SIZE - TILE_PADDING * 2, TILE_SIZE - TILE_PADDING * 2 };
+    return rect;
+}
+
+// One quad per cell
+typedef QuadBatch<CELL_COUNT> GridBatch;
+
+void renderGrid(SDL_Renderer* renderer, const Board& board, TileAtlas& atlas, const GlyphAtlas& glyphs) {
+    ++atlas.frame;
+    GridBatch batch(atlas.width, atlas.height);
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        uint32_t row = getRow(board, i);
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            SDL_Rect tileRect = cellTileRect(i * GRID_SIZE + j);
+            int exponent = (row >> (j * CELL_BITS)) & CELL_MASK;
+            if (exponent == 0) {
+                batch.add(tileRect, atlas.solid, EMPTY_CELL_COLOR);
+                continue;
+            }
+            SDL_Rect source = tileSource(renderer, atlas, glyphs, exponent);
+            if (source.w > 0) batch.add(tileRect, source, TILE_TINT);
+            else batch.add(tileRect, atlas.solid, generatedTileColor(exponent));
+        }
+    }
+    batch.draw(renderer, atlas.texture);
+}
+
+// Empty cells under every tile, plus the moving tiles
+typedef QuadBatch<CELL_COUNT * 2> SlideBatch;
+
+void renderSlide(SDL_Renderer* renderer, const SlideAnimation& slide, TileAtlas& atlas, const GlyphAtlas& glyphs) {
+    ++atlas.frame;
+    SlideBatch batch(atlas.width, atlas.height);
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        batch.add(cellTileRect(cell), atlas.solid, EMPTY_CELL_COLOR);
+    }
+    float progress = slide.progress();
+    for (int i = 0; i < slide.moveCount(); ++i) {
+        const TileMove& move = slide.moves()[i];
+        SDL_Rect from = cellTileRect(move.from);
+        SDL_Rect to = cellTileRect(move.to);
+        SDL_Rect tileRect = { from.x + (int)((to.x - from.x) * progress), from.y + (int)((to.y - from.y) * progress), from.w, from.h };
+        SDL_Rect source = tileSource(renderer, atlas, glyphs, move.exponent);
+        if (source.w > 0) batch.add(tileRect, source, TILE_TINT);
+        else batch.add(tileRect, atlas.solid, generatedTileColor(move.exponent));
+    }
+    batch.draw(renderer, atlas.texture);
+}
+
+const int OVERLAY_MARGIN = 5;
+const int OVERLAY_GRAPH_HEIGHT = 80;
+const double OVERLAY_GRAPH_MAX_MS = 1000.0 / 30; // Top of the graph, two frames at 60 Hz
+const double OVERLAY_BUDGET_MS = 1000.0 / 60;
+const float OVERLAY_TEXT_SCALE = 0.55f;
+const SDL_Color OVERLAY_BACKGROUND = { 0, 0, 0, 190 };
+const SDL_Color OVERLAY_BUDGET_LINE = { 255, 255, 255, 120 };
+const SDL_Color OVERLAY_FAST_FRAME = { 90, 220, 90, 255 };
+const SDL_Color OVERLAY_SLOW_FRAME = { 240, 70, 60, 255 };
+const SDL_Color OVERLAY_TEXT = { 255, 255, 255, 255 };
+
+// Background, budget line and one bar per frame
+typedef QuadBatch<PROFILE_HISTORY + 2> OverlayBatch;
+
+static void addOverlayRow(TextBatch& text, const GlyphAtlas& glyphs, int x, int y, const char* label, const PhaseSummary& summary) {
+    char value[16];
+    addText(text, glyphs, label, x, y, OVERLAY_TEXT, OVERLAY_TEXT_SCALE);
+    if (summary.samples == 0) return;
+    std::snprintf(value, sizeof(value), "%.3f", summary.p50Ms);
+    addText(text, glyphs, value, x + 90, y, OVERLAY_TEXT, OVERLAY_TEXT_SCALE);
+    std::snprintf(value, sizeof(value), "%.3f", summary.p99Ms);
+    addText(text, glyphs, value, x + 165, y, OVERLAY_TEXT, OVERLAY_TEXT_SCALE);
+}
+
+void renderProfilerOverlay(SDL_Renderer* renderer, const Profiler& profiler, const TileAtlas& atlas, const GlyphAtlas& glyphs) {
+    int lineHeight = (int)(glyphs.lineHeight * OVERLAY_TEXT_SCALE);
+    int width = EXTRA_WIDTH - 2 * OVERLAY_MARGIN;
+    int height = (PHASE_COUNT + 2) * lineHeight + OVERLAY_GRAPH_HEIGHT + 3 * OVERLAY_MARGIN;
+    int left = GRID_SIZE * TILE_SIZE + OVERLAY_MARGIN;
+    int top = WINDOW_HEIGHT - OVERLAY_MARGIN - height;
+
+    OverlayBatch quads(atlas.width, atlas.height);
+    SDL_Rect background = { left, top, width, height };
+    quads.add(background, atlas.solid, OVERLAY_BACKGROUND);
+
+    // Newest frame on the right, one pixel per frame
+    int graphLeft = left + (width - PROFILE_HISTORY) / 2;
+    int graphBottom = top + height - OVERLAY_MARGIN;
+    SDL_Rect budgetLine = { graphLeft, graphBottom - (int)(OVERLAY_GRAPH_HEIGHT * OVERLAY_BUDGET_MS / OVERLAY_GRAPH_MAX_MS), PROFILE_HISTORY, 1 };
+    quads.add(budgetLine, atlas.solid, OVERLAY_BUDGET_LINE);
+    int frames = profiler.frameCount();
+    for (int i = 0; i < frames; ++i) {
+        double ms = profiler.frameMs(i);
+        int barHeight = std::max(1, (int)(OVERLAY_GRAPH_HEIGHT * std::min(ms, OVERLAY_GRAPH_MAX_MS) / OVERLAY_GRAPH_MAX_MS));
+        SDL_Rect bar = { graphLeft + PROFILE_HISTORY - frames + i, graphBottom - barHeight, 1, barHeight };
+        quads.add(bar, atlas.solid, ms > OVERLAY_BUDGET_MS ? OVERLAY_SLOW_FRAME : OVERLAY_FAST_FRAME);
+    }
+    quads.draw(renderer, atlas.texture);
+
+    // Rows are flushed a few at a time; all of them overflow one TextBatch
+    TextBatch text(glyphs.width, glyphs.height);
+    int x = left + OVERLAY_MARGIN;
+    int y = top + OVERLAY_MARGIN;
+    addText(text, glyphs, "ms", x, y, OVERLAY_TEXT, OVERLAY_TEXT_SCALE);
+    addText(text, glyphs, "p50", x + 90, y, OVERLAY_TEXT, OVERLAY_TEXT_SCALE);
+    addText(text, glyphs, "p99", x + 165, y, OVERLAY_TEXT, OVERLAY_TEXT_SCALE);
+    for (int phase = 0; phase <= PHASE_COUNT; ++phase) {
+        y += lineHeight;
+        PhaseSummary summary = phase < PHASE_COUNT ? profiler.summary(phase) : profiler.frameSummary();
+        if (text.size() > MAX_TEXT_QUADS - 24) {
+            text.draw(renderer, glyphs.texture);
+            text.clear();
+        }
+        addOverlayRow(text, glyphs, x, y, profilePhaseName(phase), summary);
+    }
+    text.draw(renderer, glyphs.texture);
+}
+
+// Static chrome in window coordinates
+static void drawChrome(SDL_Renderer* renderer) {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    ++renderDrawCalls;
+
+    // Render the extra area on the right side
+    SDL_Rect extraArea = { GRID_SIZE * TILE_SIZE, 0, EXTRA_WIDTH, WINDOW_HEIGHT };
+    SDL_SetRenderDrawColor(renderer, PANEL_COLOR.r, PANEL_COLOR.g, PANEL_COLOR.b, PANEL_COLOR.a);
+    SDL_RenderFillRect(renderer, &extraArea);
+    ++renderDrawCalls;
+
+    // Render the border around the extra area
+    SDL_SetRenderDrawColor(renderer, BORDER_COLOR.r, BORDER_COLOR.g, BORDER_COLOR.b, BORDER_COLOR.a);
+    SDL_Rect extraAreaBorder = { GRID_SIZE * TILE_SIZE - BORDER_THICKNESS, -BORDER_THICKNESS, EXTRA_WIDTH + BORDER_THICKNESS, WINDOW_HEIGHT + BORDER_THICKNESS };
+    SDL_RenderDrawRect(renderer, &extraAreaBorder);
+    ++renderDrawCalls;
+
+    // Inner border around each cell, then the border around the grid
+    for (int i = 0; i < GRID_SIZE; ++i) {
+        for (int j = 0; j < GRID_SIZE; ++j) {
+            SDL_Rect innerBorderRect = { j * TILE_SIZE, i * TILE_SIZE, TILE_SIZE, TILE_SIZE };
+            SDL_RenderDrawRect(renderer, &innerBorderRect);
+            ++renderDrawCalls;
+        }
+    }
+    SDL_Rect gridRect = { 0, 0, GRID_SIZE * TILE_SIZE, GRID_SIZE * TILE_SIZE };
+    SDL_RenderDrawRect(renderer, &gridRect);
+    ++renderDrawCalls;
+}
+
+void BackgroundLayer::release() {
+    SDL_DestroyTexture(texture);
+    texture = nullptr;
+    dirty = true;
+}
+
+void BackgroundLayer::draw(SDL_Renderer* renderer) {
+    if (!texture && SDL_RenderTargetSupported(renderer)) {
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+        dirty = true;
+    }
+    // Without render targets, draw the chrome directly every frame
+    if (!texture) {
+        drawChrome(renderer);
+        return;
+    }
+
+    if (dirty) {
+        SDL_SetRenderTarget(renderer, texture);
+        drawChrome(renderer);
+        SDL_SetRenderTarget(renderer, nullptr);
+        dirty = false;
+    }
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    ++renderDrawCalls;
+}
+
+void renderPanel(SDL_Renderer* renderer, BackgroundLayer& background, const GlyphAtlas& glyphs, int score, const char* hint) {
+    background.draw(renderer);
+
+    TextBatch text(glyphs.width, glyphs.height);
+    char scoreText[16];
+    int lineHeight = glyphs.lineHeight;
+    addText(text, glyphs, "Score", GRID_SIZE * TILE_SIZE + (EXTRA_WIDTH - textWidth(glyphs, "Score")) / 2, SCORE_LABEL_Y, PANEL_TEXT_COLOR);
+    std::snprintf(scoreText, sizeof(scoreText), "%d", score);
+    int scoreValueY = SCORE_LABEL_Y + lineHeight + 10; // Positioned below the label
+    addText(text, glyphs, scoreText, GRID_SIZE * TILE_SIZE + (EXTRA_WIDTH - textWidth(glyphs, scoreText)) / 2, scoreValueY, PANEL_TEXT_COLOR);
+    if (hint) {
+        addText(text, glyphs, hint, GRID_SIZE * TILE_SIZE + (EXTRA_WIDTH - textWidth(glyphs, hint)) / 2, scoreValueY + lineHeight + 40, PANEL_TEXT_COLOR);
+    }
+    text.draw(renderer, glyphs.texture);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include "animation.h"
+#include "board.h"
+#include "profiler.h"
+#include "text.h"
+
+// Layout
+const int TILE_SIZE = 100;
+const int TILE_PADDING = 10;
+const int BORDER_THICKNESS = 10; // Uniform border thickness
+const int EXTRA_WIDTH = 250; // Extra width for additional area
+const int WINDOW_WIDTH = GRID_SIZE * TILE_SIZE + EXTRA_WIDTH;
+const int WINDOW_HEIGHT = GRID_SIZE * TILE_SIZE;
+
+const int ATLAS_TILE_EXPONENTS = 11; // Tile images exist for 2 (exponent 1) up to 2048 (exponent 11)
+const int TILE_EXPONENTS = 1 << CELL_BITS; // Every exponent a cell can hold
+const int GENERATED_TILE_SLOTS = 8; // Atlas slots for tiles drawn at run time
+
+// Every tile image packed into one texture. Slot 0 is a plain white patch that
+// flat-coloured quads (empty cells, borders) sample and tint with their vertex colour.
+// Tiles without an image (above 2048, or whose image failed to load) are drawn
+// into a fixed set of extra slots the first time they show up: a palette colour
+// with the value written from the glyph atlas. When every slot is taken the
+// least recently drawn tile makes room, so memory stays the same however high
+// the tiles get.
+struct TileAtlas {
+    SDL_Texture* texture = nullptr; // Render target when the renderer supports it, so tiles can be drawn into it
+    SDL_Surface* sheet = nullptr;   // The image slots, kept to refill the texture after SDL_RENDER_TARGETS_RESET
+    int width = 0;
+    int height = 0;
+    SDL_Rect tiles[TILE_EXPONENTS] = {}; // Source rect per exponent, w == 0 while the tile is not in the atlas
+    SDL_Rect solid = {};
+
+    bool canGenerate = false;
+    int tileSlot[TILE_EXPONENTS] = {};                 // Generated slot holding an exponent, -1 for none
+    int slotExponent[GENERATED_TILE_SLOTS] = {};       // 0 while the slot is free
+    uint64_t slotLastUsed[GENERATED_TILE_SLOTS] = {};  // Frame the slot was last drawn in
+    uint64_t frame = 0;
+};
+
+// Asset pack name of the tile image for an exponent, e.g. "8.png"
+std::string tileImageName(int exponent);
+
+// Packs decoded tile images, indexed by exponent with nullptr for missing ones,
+// into the atlas and uploads it. Must run on the thread that owns the renderer.
+bool buildTileAtlas(SDL_Renderer* renderer, SDL_Surface* const images[ATLAS_TILE_EXPONENTS + 1], TileAtlas& atlas);
+void destroyTileAtlas(TileAtlas& atlas);
+
+// Uploads the tile images again and forgets every generated tile; call on SDL_RENDER_TARGETS_RESET
+bool restoreTileAtlas(SDL_Renderer* renderer, TileAtlas& atlas);
+
+// Start screen shown while the tile images are still decoding
+void renderStartScreen(SDL_Renderer* renderer, SDL_Texture* image);
+
+// Draws every cell with one SDL_RenderGeometry call; the borders belong to BackgroundLayer.
+// A tile seen for the first time is drawn into the atlas beforehand. Tiles are
+// looked up by exponent straight from the packed board: no hashing, no allocation.
+void renderGrid(SDL_Renderer* renderer, const Board& board, TileAtlas& atlas, const GlyphAtlas& glyphs);
+
+// Draws a slide in progress: every cell empty, then each tile between its old
+// and new cell. Spawned tiles appear with the final board once the slide ends.
+void renderSlide(SDL_Renderer* renderer, const SlideAnimation& slide, TileAtlas& atlas, const GlyphAtlas& glyphs);
+// Per-phase p50/p99 and a graph of recent frame times over the bottom of the side panel
+void renderProfilerOverlay(SDL_Renderer* renderer, const Profiler& profiler, const TileAtlas& atlas, const GlyphAtlas& glyphs);
+
+// The parts of the window that never change during play: the side panel, its
+// border and the white cell and grid borders. They are drawn once into a target
+// texture and copied to the screen with one call per frame. Call invalidate()
+// when the window size or the colours change, or on SDL_RENDER_TARGETS_RESET,
+// which discards the texture contents. release() must run before the renderer
+// is destroyed.
+class BackgroundLayer {
+public:
+    void invalidate() { dirty = true; }
+    void release();
+
+    // Replaces SDL_RenderClear: the whole window is covered by the layer
+    void draw(SDL_Renderer* renderer);
+
+private:
+    SDL_Texture* texture = nullptr;
+    bool dirty = true;
+};
+
+// Side panel and borders from the background layer, then the "Score" label, the
+// score below it and the hint line (nullptr for none) as one batch of glyphs
+void renderPanel(SDL_Renderer* renderer, BackgroundLayer& background, const GlyphAtlas& glyphs, int score, const char* hint);
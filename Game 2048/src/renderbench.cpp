@@ -0,0 +1,267 @@
+// Headless render benchmark: draws scripted board sequences through the same
+// side panel, grid and slide code as the game, on SDL's offscreen (or dummy)
+// video driver with the software renderer, so it runs on a machine without a
+// display. Reports frames/sec, draw calls and heap allocations per frame for
+// each script, and fails when a warmed-up frame allocates (debug builds), e.g.
+//   g++ -O2 -std=c++17 -pthread renderbench.cpp render.cpp text.cpp board.cpp animation.cpp profiler.cpp assetpack.cpp assetloader.cpp imagecache.cpp threadpool.cpp alloccount.cpp -lSDL2 -lSDL2_image -lSDL2_ttf -o renderbench
+//   ./renderbench --pack assets.pak --frames 5000
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "alloccount.h"
+#include "assetloader.h"
+#include "render.h"
+
+const char* const HINT_LABELS[4] = { "Hint: Up", "Hint: Down", "Hint: Left", "Hint: Right" };
+const int FIRST_GENERATED_EXPONENT = ATLAS_TILE_EXPONENTS + 1;
+const int WARMUP_FRAMES = 100; // Drawn before timing; they fill the atlas and create the background layer
+
+// What the window shows on one frame of a script
+struct BenchFrame {
+    const Board* board;            // Drawn with renderGrid when slide is nullptr
+    const SlideAnimation* slide;
+    int score;
+    const char* hint;
+};
+
+// A scripted sequence of frames. Scripts play a seeded game with random moves,
+// starting over when it ends, so every run draws the same frames.
+class BenchScript {
+public:
+    virtual ~BenchScript() {}
+    virtual BenchFrame next() = 0;
+};
+
+// One frame per move: the board after the move, as during autoplay
+class PlayScript : public BenchScript {
+public:
+    explicit PlayScript(uint64_t seed) : rng(seed) { restart(); }
+
+    BenchFrame next() override {
+        int direction = (int)rng.below(4);
+        if (moveBoard(board, direction, score)) spawnTiles(board, rng);
+        if (isBoardGameOver(board)) restart();
+        BenchFrame frame = { &board, nullptr, score, HINT_LABELS[direction] };
+        return frame;
+    }
+
+private:
+    Rng rng;
+    Board board;
+    int score = 0;
+
+    void restart() {
+        initializeBoard(board, rng);
+        score = 0;
+    }
+};
+
+// Every step of the slide animation for each move, the last one showing the
+// final board, as a player sees it
+class SlideScript : public BenchScript {
+public:
+    explicit SlideScript(uint64_t seed) : rng(seed) { restart(); }
+
+    BenchFrame next() override {
+        if (slide.active()) {
+            slide.advance(ANIMATION_STEP_SECONDS);
+        }
+        else {
+            int direction = (int)rng.below(4);
+            int moveCount = 0;
+            TileMove moves[CELL_COUNT];
+            if (moveBoardTracked(board, direction, score, moves, moveCount)) {
+                spawnTiles(board, rng);
+                slide.start(moves, moveCount);
+            }
+            if (isBoardGameOver(board)) restart();
+        }
+        BenchFrame frame = { &board, slide.active() ? &slide : nullptr, score, nullptr };
+        return frame;
+    }
+
+private:
+    Rng rng;
+    Board board;
+    SlideAnimation slide;
+    int score = 0;
+
+    void restart() {
+        initializeBoard(board, rng);
+        slide.finish();
+        score = 0;
+    }
+};
+
+// Every cell above 2048 and different on each frame, so the generated atlas
+// slots are redrawn constantly: the worst case for the tile atlas
+class GeneratedScript : public BenchScript {
+public:
+    BenchFrame next() override {
+        int span = TILE_EXPONENTS - FIRST_GENERATED_EXPONENT;
+        for (int cell = 0; cell < CELL_COUNT; ++cell) {
+            setCell(board, cell / GRID_SIZE, cell % GRID_SIZE, FIRST_GENERATED_EXPONENT + (frame + cell) % span);
+        }
+        ++frame;
+        BenchFrame result = { &board, nullptr, frame, nullptr };
+        return result;
+    }
+
+private:
+    Board board;
+    int frame = 0;
+};
+
+struct BenchAssets {
+    TileAtlas tiles;
+    GlyphAtlas glyphs;
+    BackgroundLayer background;
+};
+
+static void drawFrame(SDL_Renderer* renderer, BenchAssets& assets, const BenchFrame& frame) {
+    renderPanel(renderer, assets.background, assets.glyphs, frame.score, frame.hint);
+    if (frame.slide) renderSlide(renderer, *frame.slide, assets.tiles, assets.glyphs);
+    else renderGrid(renderer, *frame.board, assets.tiles, assets.glyphs);
+    // The software renderer runs the queued commands here
+    SDL_RenderPresent(renderer);
+}
+
+// Returns false when the timed frames allocated
+static bool runScript(SDL_Renderer* renderer, BenchAssets& assets, const char* name, BenchScript& script, int frames) {
+    for (int i = 0; i < WARMUP_FRAMES; ++i) {
+        drawFrame(renderer, assets, script.next());
+    }
+
+    // The script's own moves and spawns count too: the whole cycle must stay off the heap
+    uint64_t drawCallsBefore = renderDrawCalls;
+    uint64_t allocationsBefore = threadAllocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        drawFrame(renderer, assets, script.next());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double drawCalls = (double)(renderDrawCalls - drawCallsBefore) / frames;
+    uint64_t allocations = threadAllocationCount() - allocationsBefore;
+    std::printf("%-10s %8d %10.3f %10.1f %10.3f %12.2f %12.4f%s\n", name, frames, seconds, frames / seconds, seconds * 1000 / frames,
+        drawCalls, (double)allocations / frames, allocations > 0 ? "  ALLOCATES" : "");
+    return allocations == 0;
+}
+
+static bool loadAssets(SDL_Renderer* renderer, const AssetPack& pack, BenchAssets& assets) {
+    SDL_RWops* fontStream = openPackedAsset(pack, "2048-font.ttf");
+    TTF_Font* font = fontStream ? TTF_OpenFontRW(fontStream, 1, 24) : nullptr;
+    if (!font) {
+        std::fprintf(stderr, "Failed to load font: %s\n", TTF_GetError());
+        return false;
+    }
+    bool glyphsLoaded = loadGlyphAtlas(renderer, font, assets.glyphs);
+    TTF_CloseFont(font);
+
+    SDL_Surface* tileImages[ATLAS_TILE_EXPONENTS + 1] = {};
+    for (int exponent = 1; exponent <= ATLAS_TILE_EXPONENTS; ++exponent) {
+        tileImages[exponent] = decodePackedImage(pack, tileImageName(exponent).c_str());
+    }
+    bool built = buildTileAtlas(renderer, tileImages, assets.tiles);
+    for (SDL_Surface* image : tileImages) {
+        SDL_FreeSurface(image);
+    }
+    return glyphsLoaded && built;
+}
+
+static void printUsage() {
+    std::printf("usage: renderbench [--pack FILE] [--frames N] [--script play|slide|generated|all] [--seed S]\n");
+    std::printf("                   [--driver offscreen|dummy]\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* packPath = "assets.pak";
+    const char* scriptName = "all";
+    const char* driver = nullptr;
+    int frames = 2000;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--pack") == 0 && hasValue) packPath = argv[++i];
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) frames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--script") == 0 && hasValue) scriptName = argv[++i];
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--driver") == 0 && hasValue) driver = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (frames <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    // No display needed: offscreen keeps real window framebuffers, dummy is the fallback
+    const char* drivers[2] = { "offscreen", "dummy" };
+    bool initialized = false;
+    for (const char* name : drivers) {
+        if (driver && std::strcmp(driver, name) != 0) continue;
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, name);
+        if (SDL_Init(SDL_INIT_VIDEO) == 0) {
+            initialized = true;
+            break;
+        }
+    }
+    if (!initialized || TTF_Init() == -1 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        std::fprintf(stderr, "Failed to initialize SDL: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    AssetPack pack;
+    SDL_Window* window = SDL_CreateWindow("2048 render bench", 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+    BenchAssets assets;
+    int status = 1;
+    if (!renderer) {
+        std::fprintf(stderr, "Failed to create a software renderer: %s\n", SDL_GetError());
+    }
+    else if (!pack.open(packPath)) {
+        std::fprintf(stderr, "Failed to open %s\n", packPath);
+    }
+    else if (loadAssets(renderer, pack, assets)) {
+        std::printf("driver %s, software renderer, %dx%d\n", SDL_GetCurrentVideoDriver(), WINDOW_WIDTH, WINDOW_HEIGHT);
+        std::printf("allocation counting %s\n", allocationCountingEnabled() ? "on" : "off (NDEBUG)");
+        std::printf("%-10s %8s %10s %10s %10s %12s %12s\n", "script", "frames", "seconds", "fps", "ms/frame", "draws/frame", "allocs/frame");
+        bool all = std::strcmp(scriptName, "all") == 0;
+        bool ran = false;
+        bool allocationFree = true;
+        if (all || std::strcmp(scriptName, "play") == 0) {
+            PlayScript script(seed);
+            allocationFree &= runScript(renderer, assets, "play", script, frames);
+            ran = true;
+        }
+        if (all || std::strcmp(scriptName, "slide") == 0) {
+            SlideScript script(seed);
+            allocationFree &= runScript(renderer, assets, "slide", script, frames);
+            ran = true;
+        }
+        if (all || std::strcmp(scriptName, "generated") == 0) {
+            GeneratedScript script;
+            allocationFree &= runScript(renderer, assets, "generated", script, frames);
+            ran = true;
+        }
+        if (!ran) printUsage();
+        else status = allocationFree ? 0 : 3;
+    }
+
+    assets.background.release();
+    destroyTileAtlas(assets.tiles);
+    destroyGlyphAtlas(assets.glyphs);
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (window) SDL_DestroyWindow(window);
+    IMG_Quit();
+    TTF_Quit();
+    SDL_Quit();
+    return status;
+}
@@ -0,0 +1,129 @@
+#include "replay.h"
+#include <cstdio>
+#include <cstring>
+
+const char REPLAY_MAGIC[8] = { '2', '0', '4', '8', 'R', 'P', 'L', '1' };
+
+struct ReplayHeader {
+    char magic[8];
+    uint64_t seed;
+    uint64_t stream;
+    uint64_t moveCount;
+    uint32_t rules;
+    uint32_t checksumInterval;
+};
+
+uint64_t replayChecksum(const Board& board, int score) {
+    return Rng::mix(board.lo ^ Rng::mix(board.hi ^ Rng::mix((uint64_t)(uint32_t)score)));
+}
+
+void Replay::start(uint64_t seed, uint64_t stream, uint32_t rules, uint32_t interval) {
+    gameSeed = seed;
+    gameStream = stream;
+    ruleVariant = rules;
+    checksumInterval = interval;
+    moves = 0;
+    packedMoves.clear();
+    checksums.clear();
+    packedMoves.reserve(REPLAY_RESERVE_MOVES / 4);
+    if (interval > 0) checksums.reserve(REPLAY_RESERVE_MOVES / interval);
+}
+
+void Replay::record(int direction, const Board& board, int score) {
+    if (moves % 4 == 0) packedMoves.push_back(0);
+    packedMoves.back() |= (uint8_t)((direction & 3) << (2 * (moves % 4)));
+    ++moves;
+    if (checksumInterval > 0 && moves % checksumInterval == 0) checksums.push_back(replayChecksum(board, score));
+}
+
+bool Replay::matches(uint64_t played, const Board& board, int score) const {
+    if (checksumInterval == 0 || played == 0 || played % checksumInterval != 0) return true;
+    uint64_t index = played / checksumInterval - 1;
+    return index >= checksums.size() || checksums[index] == replayChecksum(board, score);
+}
+
+bool Replay::save(const char* path) const {
+    FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    ReplayHeader header;
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header.seed = gameSeed;
+    header.stream = gameStream;
+    header.moveCount = moves;
+    header.rules = ruleVariant;
+    header.checksumInterval = checksumInterval;
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(packedMoves.data(), 1, packedMoves.size(), file) == packedMoves.size() &&
+        std::fwrite(checksums.data(), sizeof(uint64_t), checksums.size(), file) == checksums.size();
+    return std::fclose(file) == 0 && written;
+}
+
+bool Replay::load(const char* path, const char*& error) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        error = "cannot open the file";
+        return false;
+    }
+    ReplayHeader header;
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0;
+    if (!valid) error = "not a replay file";
+    else if (header.rules != RULES_DOUBLE_SPAWN) {
+        error = "unknown rule variant";
+        valid = false;
+    }
+
+    // Check the size before trusting moveCount with an allocation
+    if (valid) {
+        long start = std::ftell(file);
+        valid = std::fseek(file, 0, SEEK_END) == 0;
+        uint64_t available = valid ? (uint64_t)(std::ftell(file) - start) : 0;
+        uint64_t checksumBytes = header.checksumInterval > 0 ? header.moveCount / header.checksumInterval * sizeof(uint64_t) : 0;
+        valid = valid && std::fseek(file, start, SEEK_SET) == 0 && header.moveCount / 4 <= available &&
+            (header.moveCount + 3) / 4 + checksumBytes <= available;
+        if (!valid) error = "file is truncated";
+    }
+
+    if (valid) {
+        gameSeed = header.seed;
+        gameStream = header.stream;
+        ruleVariant = header.rules;
+        checksumInterval = header.checksumInterval;
+        moves = header.moveCount;
+        packedMoves.resize((size_t)((moves + 3) / 4));
+        checksums.resize(checksumInterval > 0 ? (size_t)(moves / checksumInterval) : 0);
+        valid = std::fread(packedMoves.data(), 1, packedMoves.size(), file) == packedMoves.size() &&
+            std::fread(checksums.data(), sizeof(uint64_t), checksums.size(), file) == checksums.size();
+        if (!valid) error = "file is truncated";
+    }
+    std::fclose(file);
+    if (!valid) {
+        moves = 0;
+        packedMoves.clear();
+        checksums.clear();
+    }
+    return valid;
+}
+
+ReplayCheck verifyReplay(const Replay& replay) {
+    ReplayCheck check;
+    if (replay.rules() != RULES_DOUBLE_SPAWN) {
+        check.error = "unknown rule variant";
+        return check;
+    }
+    Rng rng(replay.seed(), replay.stream());
+    initializeBoard(check.board, rng);
+    for (uint64_t i = 0; i < replay.moveCount(); ++i) {
+        ++check.movesPlayed;
+        if (!moveBoard(check.board, replay.move(i), check.score)) {
+            check.error = "a move does not change the board";
+            return check;
+        }
+        spawnTiles(check.board, rng);
+        if (!replay.matches(check.movesPlayed, check.board, check.score)) {
+            check.error = "board checksum mismatch";
+            return check;
+        }
+    }
+    check.ok = true;
+    return check;
+}
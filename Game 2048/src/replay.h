@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "board.h"
+
+// Rule variants a replay can be played back with
+const uint32_t RULES_DOUBLE_SPAWN = 1; // 5x5 board, a forced 2 plus one extra tile after every move
+
+const uint32_t REPLAY_CHECKSUM_INTERVAL = 1024; // Moves between stored board checksums by default
+const uint64_t REPLAY_RESERVE_MOVES = 1 << 20;  // Recording this many moves never allocates
+
+// Board and score folded into the 64-bit checksum stored in replays
+uint64_t replayChecksum(const Board& board, int score);
+
+// A game as its random stream and the moves played, 2 bits per move. Anything
+// else (every spawn, the score) follows from re-simulating with the same rules,
+// so a million moves take about 250 KB. Only moves that changed the board are
+// stored. Every checksumInterval moves the board and score are checksummed, so
+// a player can tell where a replay stopped matching the engine.
+//
+//   "2048RPL1", uint64 seed, uint64 stream, uint64 moveCount, uint32 rules, uint32 checksumInterval
+//   (moveCount + 3) / 4 bytes of moves, move i in bits 2 * (i % 4) of byte i / 4
+//   moveCount / checksumInterval x uint64 checksum, after move checksumInterval * (k + 1)
+class Replay {
+public:
+    // Starts an empty recording of a game on Rng(seed, stream); interval 0 stores no checksums
+    void start(uint64_t seed, uint64_t stream, uint32_t rules = RULES_DOUBLE_SPAWN, uint32_t checksumInterval = REPLAY_CHECKSUM_INTERVAL);
+    // Appends a move that changed the board; board and score are after its spawn
+    void record(int direction, const Board& board, int score);
+
+    bool save(const char* path) const;
+    // False, with the reason in error, for a missing, damaged or unknown file
+    bool load(const char* path, const char*& error);
+
+    uint64_t seed() const { return gameSeed; }
+    uint64_t stream() const { return gameStream; }
+    uint32_t rules() const { return ruleVariant; }
+    uint64_t moveCount() const { return moves; }
+    int move(uint64_t index) const { return (packedMoves[index / 4] >> (2 * (index % 4))) & 3; }
+
+    // False only when a checksum was stored after `played` moves and this board does not match it
+    bool matches(uint64_t played, const Board& board, int score) const;
+
+private:
+    uint64_t gameSeed = 0;
+    uint64_t gameStream = 0;
+    uint32_t ruleVariant = RULES_DOUBLE_SPAWN;
+    uint32_t checksumInterval = REPLAY_CHECKSUM_INTERVAL;
+    uint64_t moves = 0;
+    std::vector<uint8_t> packedMoves;
+    std::vector<uint64_t> checksums;
+};
+
+struct ReplayCheck {
+    bool ok = false;
+    const char* error = nullptr; // Why the replay stopped, when not ok
+    uint64_t movesPlayed = 0;    // Up to and including a move that failed
+    Board board;
+    int score = 0;
+};
+
+// Re-simulates the whole replay at engine speed, no rendering, checking every
+// move and stored checksum
+ReplayCheck verifyReplay(const Replay& replay);
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// Counter-based random stream. The n-th number is a pure function of the stream
+// key and n, so a game seeded with (seed, game index) produces the same tiles
+// no matter which thread plays it or how many games ran before it.
+struct Rng {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+
+    Rng() {}
+    explicit Rng(uint64_t seed, uint64_t stream = 0) : key(mix(seed ^ mix(stream + 0x632BE59BD9B4E019ull))) {}
+
+    static uint64_t mix(uint64_t x) {
+        // SplitMix64 finaliser
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t next() {
+        return mix(key + ++counter * 0x9E3779B97F4A7C15ull);
+    }
+
+    // Uniform value in [0, n)
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+};
@@ -0,0 +1,87 @@
+#include "simfarm.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+const int GAMES_PER_CHUNK = 8;
+
+struct GameRange {
+    int begin;
+    int end;
+};
+
+// Owners pop from the back, thieves take from the front
+struct alignas(64) WorkQueue {
+    std::mutex mutex;
+    std::deque<GameRange> ranges;
+};
+
+GameResult playGame(MovePolicy policy, uint64_t seed, uint64_t gameIndex) {
+    GameResult result;
+    Rng rng(seed, gameIndex);
+    Board board;
+    initializeBoard(board, rng);
+    while (!isBoardGameOver(board)) {
+        int direction = policy(board, rng);
+        if (direction < 0) break;
+        moveBoard(board, direction, result.score);
+        spawnTiles(board, rng);
+        ++result.moves;
+    }
+    result.maxExponent = maxTileExponent(board);
+    return result;
+}
+
+static bool popOwn(WorkQueue& queue, GameRange& range) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) return false;
+    range = queue.ranges.back();
+    queue.ranges.pop_back();
+    return true;
+}
+
+static bool steal(WorkQueue& queue, GameRange& range) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) return false;
+    range = queue.ranges.front();
+    queue.ranges.pop_front();
+    return true;
+}
+
+void runGames(MovePolicy policy, uint64_t seed, int threads, std::vector<GameResult>& results) {
+    int games = (int)results.size();
+    if (threads < 1) threads = 1;
+    std::vector<WorkQueue> queues(threads);
+
+    // Each worker starts with a contiguous block of chunks
+    int chunks = (games + GAMES_PER_CHUNK - 1) / GAMES_PER_CHUNK;
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        GameRange range = { chunk * GAMES_PER_CHUNK, std::min(games, (chunk + 1) * GAMES_PER_CHUNK) };
+        queues[(long long)chunk * threads / chunks].ranges.push_front(range);
+    }
+
+    auto worker = [&](int id) {
+        GameRange range;
+        for (;;) {
+            bool found = popOwn(queues[id], range);
+            for (int offset = 1; !found && offset < threads; ++offset) {
+                found = steal(queues[(id + offset) % threads], range);
+            }
+            // No work is created after startup, so empty queues everywhere means done
+            if (!found) return;
+            for (int game = range.begin; game < range.end; ++game) {
+                results[game] = playGame(policy, seed, (uint64_t)game);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int id = 1; id < threads; ++id) {
+        pool.emplace_back(worker, id);
+    }
+    worker(0);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "policy.h"
+
+struct GameResult {
+    int score = 0;
+    int moves = 0;
+    int maxExponent = 0;
+};
+
+// Plays one game on its own random stream (seed, gameIndex)
+GameResult playGame(MovePolicy policy, uint64_t seed, uint64_t gameIndex);
+
+// Plays games [0, results.size()) on the given number of threads. Workers own a
+// queue of game ranges and steal from each other when theirs runs dry. Each result
+// depends only on its game index, so the output is identical for any thread count.
+void runGames(MovePolicy policy, uint64_t seed, int threads, std::vector<GameResult>& results);
@@ -0,0 +1,214 @@
+// Headless self-play: plays N games with a move policy and reports throughput
+// and result distributions. Needs no SDL, window or font, e.g.
+//   g++ -O2 -std=c++17 -pthread simulate.cpp board.cpp policy.cpp simfarm.cpp ai.cpp chance.cpp threadpool.cpp replay.cpp -o simulate
+//   ./simulate --games 10000 --policy greedy --threads 8
+//   ./simulate --games 100 --policy expectimax --depth 2 --time-ms 50
+//   ./simulate --search-scaling --depth 2
+//   ./simulate --write-replay game.rpl --policy expectimax --seed 7
+//   ./simulate --verify-replay game.rpl
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include "replay.h"
+#include "simfarm.h"
+
+// Boards from the middle of seeded greedy games, used to time the search itself
+static std::vector<Board> buildSearchCorpus(uint64_t seed, int count) {
+    std::vector<Board> corpus;
+    for (uint64_t game = 0; (int)corpus.size() < count; ++game) {
+        Rng rng(seed, game);
+        Board board;
+        initializeBoard(board, rng);
+        for (int moves = 0; !isBoardGameOver(board); ++moves) {
+            int score = 0;
+            int direction = greedyPolicy(board, rng);
+            if (direction < 0) break;
+            moveBoard(board, direction, score);
+            spawnTiles(board, rng);
+            if (moves % 15 == 14 && countEmptyCells(board) >= 6 && (int)corpus.size() < count) corpus.push_back(board);
+        }
+    }
+    return corpus;
+}
+
+// Times a fixed-depth search over the corpus with 1, 2, 4, ... threads
+static void runSearchScaling(uint64_t seed, int maxThreads, SearchOptions options) {
+    options.timeBudgetMs = 0;
+    std::vector<Board> corpus = buildSearchCorpus(seed, 24);
+    evaluateBoard(corpus[0]); // Builds the heuristic table outside the timed runs
+    std::printf("search scaling, %d boards, depth %d, chance budget %d\n", (int)corpus.size(), options.maxDepth, options.chanceBudget);
+    std::printf("%8s %10s %14s %9s %11s\n", "threads", "seconds", "nodes/sec", "speedup", "efficiency");
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    double baseSeconds = 0;
+    for (int threads : threadCounts) {
+        ParallelSearch search(threads);
+        search.table.resize(options.tableBits);
+        uint64_t nodes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const Board& board : corpus) {
+            nodes += searchBestMoveParallel(search, board, options).stats.nodes;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (threads == 1) baseSeconds = seconds;
+        double speedup = baseSeconds / seconds;
+        std::printf("%8d %10.3f %14.0f %9.2f %10.1f%%\n", threads, seconds, nodes / seconds, speedup, 100.0 * speedup / threads);
+    }
+}
+
+// Plays one game and records it. The policy draws from its own stream: a replay
+// only holds the spawn stream, so spawns must not depend on the policy's draws.
+static bool writeReplay(MovePolicy policy, uint64_t seed, const char* path) {
+    Replay replay;
+    replay.start(seed, 0);
+    Rng rng(seed, 0);
+    Rng policyRng(seed, 1);
+    Board board;
+    int score = 0;
+    initializeBoard(board, rng);
+    while (!isBoardGameOver(board)) {
+        int direction = policy(board, policyRng);
+        if (direction < 0 || !moveBoard(board, direction, score)) break;
+        spawnTiles(board, rng);
+        replay.record(direction, board, score);
+    }
+    if (!replay.save(path)) {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    std::printf("replay %s: seed %llu, %llu moves, score %d, max tile %d\n", path, (unsigned long long)seed,
+        (unsigned long long)replay.moveCount(), score, exponentToValue(maxTileExponent(board)));
+    return true;
+}
+
+// Re-simulates a replay without rendering and reports how fast that ran
+static bool verifyReplayFile(const char* path) {
+    Replay replay;
+    const char* error = nullptr;
+    if (!replay.load(path, error)) {
+        std::fprintf(stderr, "cannot load %s: %s\n", path, error);
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    ReplayCheck check = verifyReplay(replay);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("replay %s: seed %llu stream %llu, %llu moves\n", path, (unsigned long long)replay.seed(), (unsigned long long)replay.stream(),
+        (unsigned long long)replay.moveCount());
+    std::printf("verified    %.3f s, %.0f moves/sec\n", seconds, seconds > 0 ? check.movesPlayed / seconds : 0.0);
+    if (!check.ok) {
+        std::printf("FAILED      at move %llu: %s\n", (unsigned long long)check.movesPlayed, check.error);
+        return false;
+    }
+    std::printf("ok          score %d, max tile %d%s\n", check.score, exponentToValue(maxTileExponent(check.board)),
+        isBoardGameOver(check.board) ? ", game over" : "");
+    return true;
+}
+
+static void printUsage() {
+    std::printf("usage: simulate [--games N] [--policy NAME] [--seed S] [--threads T]\n");
+    std::printf("                [--depth D] [--time-ms MS] [--cutoff P] [--chance-budget B]   (expectimax)\n");
+    std::printf("                [--search-threads T]   (one parallel search per move, games run one at a time)\n");
+    std::printf("       simulate --search-scaling [--threads T] [--depth D] [--seed S]\n");
+    std::printf("       simulate --write-replay FILE [--policy NAME] [--seed S]   (records one game)\n");
+    std::printf("       simulate --verify-replay FILE\n");
+    std::printf("policies: %s\n", policyNames());
+}
+
+int main(int argc, char* argv[]) {
+    int games = 1000;
+    std::string policyName = "greedy";
+    uint64_t seed = (uint64_t)std::time(nullptr);
+    int threads = (int)std::thread::hardware_concurrency();
+    SearchOptions searchOptions;
+    int searchThreads = 1;
+    bool searchScaling = false;
+    const char* writeReplayPath = nullptr;
+    const char* verifyReplayPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--games") == 0 && hasValue) games = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--policy") == 0 && hasValue) policyName = argv[++i];
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--depth") == 0 && hasValue) searchOptions.maxDepth = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--time-ms") == 0 && hasValue) searchOptions.timeBudgetMs = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--cutoff") == 0 && hasValue) searchOptions.probabilityCutoff = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--chance-budget") == 0 && hasValue) searchOptions.chanceBudget = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--search-threads") == 0 && hasValue) searchThreads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--search-scaling") == 0) searchScaling = true;
+        else if (std::strcmp(argv[i], "--write-replay") == 0 && hasValue) writeReplayPath = argv[++i];
+        else if (std::strcmp(argv[i], "--verify-replay") == 0 && hasValue) verifyReplayPath = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (threads < 1) threads = 1;
+    if (searchScaling) {
+        runSearchScaling(seed, threads, searchOptions);
+        return 0;
+    }
+    if (verifyReplayPath) return verifyReplayFile(verifyReplayPath) ? 0 : 1;
+
+    MovePolicy policy = findPolicy(policyName);
+    if (!policy || games <= 0) {
+        printUsage();
+        return 1;
+    }
+    if (searchThreads > 1) threads = 1;
+    setPolicySearchOptions(searchOptions, searchThreads);
+    if (writeReplayPath) return writeReplay(policy, seed, writeReplayPath) ? 0 : 1;
+
+    std::vector<GameResult> results(games);
+    auto start = std::chrono::steady_clock::now();
+    runGames(policy, seed, threads, results);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Order-sensitive digest of every result, equal across thread counts for the same seed
+    uint64_t digest = 0;
+    long long totalMoves = 0;
+    double totalScore = 0;
+    int tileCounts[32] = {};
+    std::vector<int> scores(games);
+    for (int i = 0; i < games; ++i) {
+        totalMoves += results[i].moves;
+        totalScore += results[i].score;
+        scores[i] = results[i].score;
+        ++tileCounts[results[i].maxExponent];
+        digest = Rng::mix(digest ^ ((uint64_t)results[i].score << 32 | (uint64_t)results[i].moves << 8 | (uint64_t)results[i].maxExponent));
+    }
+    std::sort(scores.begin(), scores.end());
+    auto percentile = [&](double p) { return scores[(size_t)(p * (games - 1))]; };
+
+    std::printf("policy %s, %d games, seed %llu, %d threads\n", policyName.c_str(), games, (unsigned long long)seed, threads);
+    std::printf("time        %.3f s\n", seconds);
+    std::printf("games/sec   %.1f\n", games / seconds);
+    std::printf("moves/sec   %.0f\n", totalMoves / seconds);
+    std::printf("moves/game  %.1f\n", (double)totalMoves / games);
+    std::printf("score       min %d  p10 %d  p50 %d  p90 %d  p99 %d  max %d  mean %.1f\n",
+        scores.front(), percentile(0.10), percentile(0.50), percentile(0.90), percentile(0.99), scores.back(), totalScore / games);
+    std::printf("max tile\n");
+    for (int exponent = 1; exponent < 32; ++exponent) {
+        if (tileCounts[exponent] == 0) continue;
+        std::printf("  %10d  %8d  %6.2f%%\n", exponentToValue(exponent), tileCounts[exponent], 100.0 * tileCounts[exponent] / games);
+    }
+    SearchStats search = policySearchStats();
+    if (search.nodes > 0) {
+        std::printf("search      %llu nodes, %.0f nodes/sec while searching, %.0f nodes/sec overall, avg depth %d, table hits %.1f%%\n",
+            (unsigned long long)search.nodes, search.nodes / search.seconds, search.nodes / seconds, search.depthReached,
+            100.0 * search.tableHits / search.nodes);
+    }
+    std::printf("digest      %016llx\n", (unsigned long long)digest);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "text.h"
+#include <algorithm>
+#include <iostream>
+
+const int GLYPH_SHEET_WIDTH = 512;
+const int GLYPH_GUTTER = 1;
+const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+bool loadGlyphAtlas(SDL_Renderer* renderer, TTF_Font* font, GlyphAtlas& atlas) {
+    const SDL_Color white = { 255, 255, 255, 255 };
+    atlas.lineHeight = TTF_FontHeight(font);
+
+    // Rasterise every glyph and place it on a shelf, starting a new shelf when the row is full
+    SDL_Surface* images[GLYPH_COUNT] = {};
+    int x = GLYPH_GUTTER;
+    int y = GLYPH_GUTTER;
+    int shelfHeight = 0;
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        Glyph& glyph = atlas.glyphs[i];
+        Uint16 ch = (Uint16)(FIRST_GLYPH + i);
+        int minX, maxX, minY, maxY;
+        if (TTF_GlyphMetrics(font, ch, &minX, &maxX, &minY, &maxY, &glyph.advance) != 0) continue;
+        glyph.offsetX = std::min(0, minX);
+
+        images[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        // Blank glyphs such as the space render as a transparent surface and get a
+        // cell like any other; only a glyph that fails to render keeps source.w == 0
+        // and just advances the pen
+        if (!images[i]) continue;
+        if (x + images[i]->w + GLYPH_GUTTER > GLYPH_SHEET_WIDTH) {
+            x = GLYPH_GUTTER;
+            y += shelfHeight + GLYPH_GUTTER;
+            shelfHeight = 0;
+        }
+        glyph.source = { x, y, images[i]->w, images[i]->h };
+        x += images[i]->w + GLYPH_GUTTER;
+        shelfHeight = std::max(shelfHeight, images[i]->h);
+    }
+    atlas.width = GLYPH_SHEET_WIDTH;
+    atlas.height = y + shelfHeight + GLYPH_GUTTER;
+
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas.width, atlas.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (sheet) {
+        SDL_FillRect(sheet, nullptr, SDL_MapRGBA(sheet->format, 255, 255, 255, 0));
+        for (int i = 0; i < GLYPH_COUNT; ++i) {
+            if (!images[i]) continue;
+            SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(images[i], nullptr, sheet, &atlas.glyphs[i].source);
+        }
+        atlas.texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        SDL_FreeSurface(sheet);
+    }
+    for (SDL_Surface* image : images) {
+        SDL_FreeSurface(image);
+    }
+    if (!atlas.texture) {
+        std::cerr << "Failed to create glyph atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+void destroyGlyphAtlas(GlyphAtlas& atlas) {
+    SDL_DestroyTexture(atlas.texture);
+    atlas.texture = nullptr;
+}
+
+static const Glyph* findGlyph(const GlyphAtlas& atlas, char c) {
+    int ch = (unsigned char)c;
+    if (ch < FIRST_GLYPH || ch > LAST_GLYPH) return nullptr;
+    return &atlas.glyphs[ch - FIRST_GLYPH];
+}
+
+int textWidth(const GlyphAtlas& atlas, const char* text) {
+    int width = 0;
+    for (; *text; ++text) {
+        const Glyph* glyph = findGlyph(atlas, *text);
+        if (glyph) width += glyph->advance;
+    }
+    return width;
+}
+
+void addText(TextBatch& batch, const GlyphAtlas& atlas, const char* text, int x, int y, SDL_Color color, float scale) {
+    float pen = (float)x;
+    for (; *text; ++text) {
+        const Glyph* glyph = findGlyph(atlas, *text);
+        if (!glyph) continue;
+        if (glyph->source.w > 0) {
+            SDL_Rect dst = { (int)(pen + glyph->offsetX * scale), y, (int)(glyph->source.w * scale + 0.5f), (int)(glyph->source.h * scale + 0.5f) };
+            batch.add(dst, glyph->source, color);
+        }
+        pen += glyph->advance * scale;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "quadbatch.h"
+
+// Printable ASCII, rasterised once at startup
+const int FIRST_GLYPH = 32;
+const int LAST_GLYPH = 126;
+const int MAX_TEXT_QUADS = 128; // Glyphs one TextBatch can hold
+
+struct Glyph {
+    SDL_Rect source = {}; // In the atlas, w == 0 for glyphs with no pixels such as space
+    int offsetX = 0;      // From the pen position to the left edge of source
+    int advance = 0;
+};
+
+// Every glyph of one font in one white texture; text takes its colour from the
+// vertex colour, so any colour is drawn from the same atlas.
+struct GlyphAtlas {
+    SDL_Texture* texture = nullptr;
+    int width = 0;
+    int height = 0;
+    int lineHeight = 0;
+    Glyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];
+};
+
+typedef QuadBatch<MAX_TEXT_QUADS> TextBatch;
+
+bool loadGlyphAtlas(SDL_Renderer* renderer, TTF_Font* font, GlyphAtlas& atlas);
+void destroyGlyphAtlas(GlyphAtlas& atlas);
+
+// Characters outside FIRST_GLYPH..LAST_GLYPH are skipped
+int textWidth(const GlyphAtlas& atlas, const char* text);
+void addText(TextBatch& batch, const GlyphAtlas& atlas, const char* text, int x, int y, SDL_Color color, float scale = 1.0f);
@@ -0,0 +1,63 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int threads) : nextIndex(0) {
+    for (int worker = 1; worker < threads; ++worker) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::runTasks(int worker) {
+    for (int index = nextIndex.fetch_add(1); index < taskCount; index = nextIndex.fetch_add(1)) {
+        (*task)(worker, index);
+    }
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runTasks(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int, int)>& task) {
+    if (workers.empty()) {
+        for (int index = 0; index < count; ++index) task(0, index);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        taskCount = count;
+        nextIndex = 0;
+        busyWorkers = (int)workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+    runTasks(0);
+
+    // Every worker checks in once per generation, even if it found nothing left to do
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busyWorkers == 0; });
+    this->task = nullptr;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join loops. The calling thread takes part
+// as worker 0, so a pool of size 1 runs everything inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    // Calls task(worker, index) for every index in [0, count) and returns when all
+    // are done. Indices are handed out one at a time, so uneven tasks balance out.
+    void parallelFor(int count, const std::function<void(int, int)>& task);
+
+private:
+    void workerLoop(int worker);
+    void runTasks(int worker);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int, int)>* task = nullptr;
+    std::atomic<int> nextIndex;
+    int taskCount = 0;
+    int busyWorkers = 0;
+    unsigned long long generation = 0;
+    bool stopping = false;
+};
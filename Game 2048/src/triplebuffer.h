@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+
+// Single-producer, single-consumer snapshot exchange. The writer always has a
+// buffer of its own to fill and the reader always has one to look at, so neither
+// side ever waits; the reader just sees the newest snapshot published so far.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side: fill writeBuffer(), then publish() it
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        int previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side: swaps in the newest snapshot if one was published since the last call
+    bool update() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4; // Set while the middle buffer holds an unread snapshot
+
+    T buffers[3];
+    std::atomic<int> middle{ 1 };
+    int writeIndex = 0;
+    int readIndex = 2;
+};